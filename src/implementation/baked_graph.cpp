@@ -0,0 +1,381 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+module pragma.shadergraph;
+
+import :baked_graph;
+import :graph;
+import :nodes.math;
+
+using namespace pragma::shadergraph;
+
+namespace {
+	template<typename T>
+	BakedGraph::Range append_section(std::vector<std::byte> &data, const std::vector<T> &elements)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		auto offset = (data.size() + alignof(T) - 1) / alignof(T) * alignof(T);
+		auto size = elements.size() * sizeof(T);
+		data.resize(offset + size);
+		if(size > 0)
+			std::memcpy(data.data() + offset, elements.data(), size);
+		return {static_cast<uint32_t>(offset), static_cast<uint32_t>(elements.size())};
+	}
+	template<typename T>
+	bool is_valid_section(const BakedGraph::Range &range, size_t dataSize)
+	{
+		return range.offset % alignof(T) == 0 && static_cast<uint64_t>(range.offset) + static_cast<uint64_t>(range.count) * sizeof(T) <= dataSize;
+	}
+};
+
+bool BakedGraph::Bake(const Graph &graph, std::vector<std::byte> &outData, std::string &outErr)
+{
+	std::ostringstream glslHeader, glslBody;
+	try {
+		graph.GenerateGlsl(glslHeader, glslBody);
+	}
+	catch(const std::exception &e) {
+		outErr = e.what();
+		return false;
+	}
+	// Graphs with nodes that cannot be evaluated on the CPU only contain the GLSL code
+	BytecodeProgram program;
+	std::string bytecodeErr;
+	auto hasBytecode = graph.CompileBytecode(program, bytecodeErr);
+
+	std::vector<StringEntry> strings;
+	std::vector<char> characters;
+	std::unordered_map<std::string, uint32_t> stringToIndex;
+	auto intern = [&](const std::string_view &str) -> uint32_t {
+		auto [it, inserted] = stringToIndex.try_emplace(std::string {str}, static_cast<uint32_t>(strings.size()));
+		if(inserted) {
+			strings.push_back({static_cast<uint32_t>(characters.size()), static_cast<uint32_t>(str.size())});
+			characters.insert(characters.end(), str.begin(), str.end());
+		}
+		return it->second;
+	};
+
+	Header header {};
+	header.identifier = IDENTIFIER;
+	header.version = VERSION;
+	header.registryFingerprint = graph.GetNodeRegistry()->GetFingerprint();
+	header.glslHeader = intern(glslHeader.str());
+	header.glslBody = intern(glslBody.str());
+
+	std::vector<NodeEntry> nodes;
+	std::vector<BindingEntry> inputs;
+	std::vector<BindingEntry> outputs;
+	if(hasBytecode) {
+		header.flags = Flags::HasBytecode;
+		nodes.reserve(program.GetInstructions().size());
+		for(auto &instr : program.GetInstructions())
+			nodes.push_back({intern(instr.node->GetType()), instr.variant, instr.firstOperand, instr.numInputs, static_cast<uint32_t>(instr.node->GetOutputs().size())});
+		auto bakeBindings = [&intern](const std::vector<BytecodeProgram::SocketBinding> &bindings, std::vector<BindingEntry> &outBindings) {
+			outBindings.reserve(bindings.size());
+			for(auto &binding : bindings)
+				outBindings.push_back({intern(binding.nodeName), intern(binding.socketName), math::to_integral(binding.type), binding.reg});
+		};
+		bakeBindings(program.GetInputs(), inputs);
+		bakeBindings(program.GetOutputs(), outputs);
+	}
+
+	outData.clear();
+	outData.resize(sizeof(Header));
+	header.strings = append_section(outData, strings);
+	header.characters = append_section(outData, characters);
+	header.nodes = append_section(outData, nodes);
+	if(hasBytecode) {
+		header.operands = append_section(outData, program.GetOperands());
+		header.initialRegisters = append_section(outData, program.GetInitialRegisters());
+	}
+	header.inputs = append_section(outData, inputs);
+	header.outputs = append_section(outData, outputs);
+	if(outData.size() > std::numeric_limits<uint32_t>::max()) {
+		outErr = "Baked graph exceeds the maximum size of 4 GiB!";
+		return false;
+	}
+	std::memcpy(outData.data(), &header, sizeof(header));
+	return true;
+}
+
+bool BakedGraph::Bake(const Graph &graph, const std::string &filePath, std::string &outErr)
+{
+	std::vector<std::byte> data;
+	if(!Bake(graph, data, outErr))
+		return false;
+	std::ofstream out {filePath, std::ios::binary | std::ios::trunc};
+	if(!out) {
+		outErr = "Failed to open '" + filePath + "' for writing!";
+		return false;
+	}
+	out.write(reinterpret_cast<const char *>(data.data()), data.size());
+	if(!out) {
+		outErr = "Failed to write baked graph to '" + filePath + "'!";
+		return false;
+	}
+	return true;
+}
+
+std::unique_ptr<BakedGraph> BakedGraph::Open(const std::string &filePath, std::string &outErr)
+{
+	void *mapping = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	auto hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(hFile == INVALID_HANDLE_VALUE) {
+		outErr = "Failed to open '" + filePath + "'!";
+		return nullptr;
+	}
+	LARGE_INTEGER fileSize;
+	if(GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0) {
+		size = static_cast<size_t>(fileSize.QuadPart);
+		// The view keeps the mapping alive, so both handles can be closed right away
+		auto hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(hMapping) {
+			mapping = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(hMapping);
+		}
+	}
+	CloseHandle(hFile);
+#else
+	auto fd = open(filePath.c_str(), O_RDONLY);
+	if(fd < 0) {
+		outErr = "Failed to open '" + filePath + "'!";
+		return nullptr;
+	}
+	struct stat st;
+	if(fstat(fd, &st) == 0 && st.st_size > 0) {
+		size = static_cast<size_t>(st.st_size);
+		mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping == MAP_FAILED)
+			mapping = nullptr;
+	}
+	close(fd);
+#endif
+	if(!mapping) {
+		outErr = "Failed to map '" + filePath + "' into memory!";
+		return nullptr;
+	}
+	std::unique_ptr<BakedGraph> bakedGraph {new BakedGraph {}};
+	bakedGraph->m_mapping = mapping;
+	bakedGraph->m_mappingSize = size;
+	bakedGraph->m_data = {static_cast<const std::byte *>(mapping), size};
+	if(!bakedGraph->Validate(outErr))
+		return nullptr;
+	return bakedGraph;
+}
+
+std::unique_ptr<BakedGraph> BakedGraph::FromMemory(std::span<const std::byte> data, std::string &outErr)
+{
+	std::unique_ptr<BakedGraph> bakedGraph {new BakedGraph {}};
+	bakedGraph->m_data = data;
+	if(!bakedGraph->Validate(outErr))
+		return nullptr;
+	return bakedGraph;
+}
+
+BakedGraph::~BakedGraph()
+{
+	if(!m_mapping)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_mapping);
+#else
+	munmap(m_mapping, m_mappingSize);
+#endif
+}
+
+bool BakedGraph::Validate(std::string &outErr) const
+{
+	// Only the bounds are checked here, which doesn't require touching the contents of the larger sections.
+	// The nodes, operands and registers are validated against the node types by CreateProgram.
+	if(m_data.size() < sizeof(Header) || reinterpret_cast<uintptr_t>(m_data.data()) % alignof(Header) != 0) {
+		outErr = "Invalid baked graph!";
+		return false;
+	}
+	auto &header = GetHeader();
+	if(header.identifier != IDENTIFIER) {
+		outErr = "Data is not a baked shader graph!";
+		return false;
+	}
+	if(header.version != VERSION) {
+		outErr = "Unsupported baked graph version " + util::to_string(header.version) + "!";
+		return false;
+	}
+	auto size = m_data.size();
+	if(!is_valid_section<StringEntry>(header.strings, size) || !is_valid_section<char>(header.characters, size) || !is_valid_section<NodeEntry>(header.nodes, size) || !is_valid_section<Register>(header.operands, size)
+	  || !is_valid_section<float>(header.initialRegisters, size) || !is_valid_section<BindingEntry>(header.inputs, size) || !is_valid_section<BindingEntry>(header.outputs, size)) {
+		outErr = "Baked graph is truncated or corrupt!";
+		return false;
+	}
+	auto numStrings = header.strings.count;
+	for(auto &str : GetSection<StringEntry>(header.strings)) {
+		if(static_cast<uint64_t>(str.offset) + str.length > header.characters.count) {
+			outErr = "Baked graph contains an invalid string!";
+			return false;
+		}
+	}
+	auto isValidBinding = [numStrings](const BindingEntry &binding) { return binding.nodeName < numStrings && binding.socketName < numStrings; };
+	if(header.glslHeader >= numStrings || header.glslBody >= numStrings || std::any_of(GetNodes().begin(), GetNodes().end(), [numStrings](const NodeEntry &node) { return node.type >= numStrings; })
+	  || !std::all_of(GetInputs().begin(), GetInputs().end(), isValidBinding) || !std::all_of(GetOutputs().begin(), GetOutputs().end(), isValidBinding)) {
+		outErr = "Baked graph contains an invalid string reference!";
+		return false;
+	}
+	return true;
+}
+
+std::string_view BakedGraph::GetString(uint32_t idx) const
+{
+	auto &header = GetHeader();
+	auto &str = GetSection<StringEntry>(header.strings)[idx];
+	return {reinterpret_cast<const char *>(m_data.data() + header.characters.offset + str.offset), str.length};
+}
+
+bool BakedGraph::CreateProgram(const NodeRegistry &reg, BytecodeProgram &outProgram, std::string &outErr) const
+{
+	auto &header = GetHeader();
+	if(!HasBytecode()) {
+		outErr = "Baked graph contains no bytecode, since not all of its nodes can be evaluated on the CPU!";
+		return false;
+	}
+	// The kernel variants were determined at bake time and are only valid for the same node types
+	if(reg.GetFingerprint() != header.registryFingerprint) {
+		outErr = "Baked graph was created with a different node registry!";
+		return false;
+	}
+	auto &program = outProgram;
+	program.Clear();
+	auto operands = GetOperands();
+	auto initialRegisters = GetInitialRegisters();
+	auto numRegisters = initialRegisters.size();
+	program.m_operands.assign(operands.begin(), operands.end());
+	program.m_initialRegisters.assign(initialRegisters.begin(), initialRegisters.end());
+
+	// Node types by string index, so that every type is only looked up once
+	std::vector<const Node *> nodeTypes(header.strings.count, nullptr);
+	auto nodes = GetNodes();
+	program.m_instructions.reserve(nodes.size());
+	for(auto &node : nodes) {
+		auto *&nodeType = nodeTypes[node.type];
+		if(!nodeType) {
+			auto type = GetString(node.type);
+			auto ptr = reg.GetNode(std::string {type});
+			if(!ptr) {
+				outErr = "Unknown node type '" + std::string {type} + "'!";
+				return false;
+			}
+			nodeType = ptr.get();
+		}
+		// The kernels access the operands and registers according to the sockets of the node type, so the entry has to match it exactly
+		auto &inputs = nodeType->GetInputs();
+		auto &outputs = nodeType->GetOutputs();
+		if(node.numInputs != inputs.size() || node.numOutputs != outputs.size() || !nodeType->HasKernel() || !nodeType->IsValidKernelVariant(node.variant)) {
+			outErr = "Baked graph contains a node that doesn't match node type '" + std::string {nodeType->GetType()} + "'!";
+			return false;
+		}
+		if(static_cast<uint64_t>(node.firstOperand) + node.numInputs + node.numOutputs > operands.size()) {
+			outErr = "Baked graph contains an invalid operand range!";
+			return false;
+		}
+		auto isValidOperand = [numRegisters](Register reg, const Socket &socket) {
+			auto n = get_register_count(socket.type);
+			return n > 0 && static_cast<uint64_t>(reg) + n <= numRegisters;
+		};
+		auto *nodeOperands = operands.data() + node.firstOperand;
+		for(size_t i = 0; i < inputs.size(); ++i) {
+			if(!isValidOperand(nodeOperands[i], inputs[i])) {
+				outErr = "Baked graph contains an invalid register!";
+				return false;
+			}
+		}
+		for(size_t i = 0; i < outputs.size(); ++i) {
+			if(!isValidOperand(nodeOperands[inputs.size() + i], outputs[i])) {
+				outErr = "Baked graph contains an invalid register!";
+				return false;
+			}
+		}
+		program.m_instructions.push_back({nodeType, node.variant, node.firstOperand, node.numInputs});
+	}
+
+	auto createBindings = [this, numRegisters, &outErr](std::span<const BindingEntry> bindings, std::vector<BytecodeProgram::SocketBinding> &outBindings) -> bool {
+		outBindings.reserve(bindings.size());
+		for(auto &binding : bindings) {
+			auto type = static_cast<DataType>(binding.type);
+			auto n = get_register_count(type);
+			if(n == 0 || static_cast<uint64_t>(binding.reg) + n > numRegisters) {
+				outErr = "Baked graph contains an invalid socket binding!";
+				return false;
+			}
+			outBindings.push_back({std::string {GetString(binding.nodeName)}, std::string {GetString(binding.socketName)}, type, binding.reg});
+		}
+		return true;
+	};
+	return createBindings(GetInputs(), program.m_inputs) && createBindings(GetOutputs(), program.m_outputs);
+}
+
+void BakedGraph::Benchmark(uint32_t nodeCount, uint32_t iterations)
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+
+	Graph graph {reg};
+	Graph::BuildRandomGraph(graph, nodeCount);
+
+	auto tmpDir = std::filesystem::temp_directory_path();
+	auto binaryPath = (tmpDir / (std::string {"psg_baked_benchmark."} + Graph::EXTENSION_BINARY)).string();
+	auto bakedPath = (tmpDir / (std::string {"psg_baked_benchmark."} + EXTENSION)).string();
+	std::string err;
+	if(!graph.Save(binaryPath, err) || !Bake(graph, bakedPath, err)) {
+		std::cout << "Failed to write benchmark files: " << err << std::endl;
+		return;
+	}
+
+	BytecodeProgram programLoaded;
+	auto t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i) {
+		Graph loaded {reg};
+		if(!loaded.Load(binaryPath, err) || !loaded.CompileBytecode(programLoaded, err)) {
+			std::cout << "Failed to load graph: " << err << std::endl;
+			return;
+		}
+	}
+	std::chrono::duration<double> dtLoad = std::chrono::steady_clock::now() - t;
+
+	BytecodeProgram programBaked;
+	t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i) {
+		auto baked = Open(bakedPath, err);
+		if(!baked || !baked->CreateProgram(*reg, programBaked, err)) {
+			std::cout << "Failed to open baked graph: " << err << std::endl;
+			return;
+		}
+	}
+	std::chrono::duration<double> dtBaked = std::chrono::steady_clock::now() - t;
+
+	std::error_code ec;
+	std::filesystem::remove(binaryPath, ec);
+	std::filesystem::remove(bakedPath, ec);
+
+	BytecodeInterpreter interpreterLoaded {programLoaded};
+	BytecodeInterpreter interpreterBaked {programBaked};
+	interpreterLoaded.Execute();
+	interpreterBaked.Execute();
+	auto match = programLoaded.GetRegisterCount() == programBaked.GetRegisterCount()
+	  && std::equal(interpreterLoaded.GetRegisters(), interpreterLoaded.GetRegisters() + programLoaded.GetRegisterCount(), interpreterBaked.GetRegisters());
+
+	std::cout << "Loaded graph with " << nodeCount << " nodes " << iterations << " times\n";
+	std::cout << "Graph::Load + CompileBytecode:       " << (dtLoad.count() / iterations * 1'000.0) << " ms\n";
+	std::cout << "BakedGraph::Open + CreateProgram:    " << (dtBaked.count() / iterations * 1'000.0) << " ms\n";
+	std::cout << "Speedup: " << (dtLoad.count() / dtBaked.count()) << "x, results " << (match ? "match" : "DIFFER") << std::endl;
+}
@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+
+module pragma.shadergraph;
+
+import :batch_compiler;
+import :nodes.math;
+
+using namespace pragma::shadergraph;
+
+double BatchCompiler::Statistics::GetItemsPerSecond() const
+{
+	std::chrono::duration<double> dt = wallTime;
+	if(dt.count() <= 0.0)
+		return 0.0;
+	return static_cast<double>(numSucceeded + numFailed) / dt.count();
+}
+
+BatchCompiler::BatchCompiler(const std::shared_ptr<NodeRegistry> &reg, uint32_t threadCount) : m_nodeRegistry {reg}, m_threadPool {threadCount} {}
+
+void BatchCompiler::Compile(const Item &item, Result &outResult) const
+{
+	auto t = std::chrono::steady_clock::now();
+	std::optional<Graph> loadedGraph {};
+	auto *graph = item.graph;
+	if(!graph) {
+		loadedGraph.emplace(m_nodeRegistry);
+		if(!loadedGraph->Load(item.filePath, outResult.error)) {
+			outResult.error = "Failed to load '" + item.filePath + "': " + outResult.error;
+			outResult.loadTime = std::chrono::steady_clock::now() - t;
+			return;
+		}
+		graph = &*loadedGraph;
+	}
+	auto tCompile = std::chrono::steady_clock::now();
+	outResult.loadTime = tCompile - t;
+
+	std::ostringstream header, body;
+	if(m_glslCache)
+		m_glslCache->GenerateGlsl(*graph, header, body, item.namePrefix);
+	else
+		graph->GenerateGlsl(header, body, item.namePrefix);
+	outResult.glslHeader = header.str();
+	outResult.glslBody = body.str();
+	outResult.success = true;
+	outResult.compileTime = std::chrono::steady_clock::now() - tCompile;
+}
+
+BatchCompiler::Statistics BatchCompiler::CompileBatch(std::span<const Item> items, const ResultCallback &callback)
+{
+	Statistics stats {};
+	stats.threadCount = GetThreadCount();
+
+	std::mutex resultMutex;
+	auto t = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < items.size(); ++i) {
+		m_threadPool.Submit([this, i, &items, &callback, &stats, &resultMutex](uint32_t threadIdx) {
+			Result result {};
+			result.itemIndex = i;
+			result.threadIndex = threadIdx;
+			try {
+				Compile(items[i], result);
+			}
+			catch(const std::exception &e) {
+				result.success = false;
+				result.error = e.what();
+			}
+
+			std::scoped_lock lock {resultMutex};
+			if(result.success)
+				++stats.numSucceeded;
+			else
+				++stats.numFailed;
+			auto itemTime = result.loadTime + result.compileTime;
+			stats.totalItemTime += itemTime;
+			stats.maxItemTime = std::max(stats.maxItemTime, itemTime);
+			if(callback)
+				callback(std::move(result));
+		});
+	}
+	m_threadPool.Wait();
+	stats.wallTime = std::chrono::steady_clock::now() - t;
+	return stats;
+}
+
+void BatchCompiler::Test()
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+
+	constexpr uint32_t numGraphs = 64;
+	std::vector<std::unique_ptr<Graph>> graphs;
+	graphs.reserve(numGraphs);
+	for(uint32_t i = 0; i < numGraphs; ++i) {
+		graphs.push_back(std::make_unique<Graph>(reg));
+		Graph::BuildRandomGraph(*graphs.back(), 50 + (i % 8) * 25, i);
+	}
+
+	// Every fourth graph is compiled from a file, one item refers to a file that doesn't exist and one graph is compiled twice
+	auto tmpDir = std::filesystem::temp_directory_path();
+	std::vector<Item> items;
+	items.reserve(numGraphs + 2);
+	for(uint32_t i = 0; i < numGraphs; ++i) {
+		Item item {};
+		if(i % 4 == 0) {
+			item.filePath = (tmpDir / ("psg_batch_test_" + std::to_string(i) + "." + Graph::EXTENSION_BINARY)).string();
+			std::string err;
+			[[maybe_unused]] auto saved = graphs[i]->Save(item.filePath, err);
+			assert(saved);
+		}
+		else
+			item.graph = graphs[i].get();
+		items.push_back(std::move(item));
+	}
+	items.push_back({nullptr, (tmpDir / "psg_batch_test_missing.psg_b").string()});
+	auto missingItemIdx = items.size() - 1;
+	items.push_back({graphs[1].get()});
+
+	// Reference results on a single thread
+	BatchCompiler serialCompiler {reg, 1};
+	std::vector<Result> expected(items.size());
+	serialCompiler.CompileBatch(items, [&expected](Result &&result) { expected[result.itemIndex] = std::move(result); });
+
+	// The parallel batches are repeated to give races a chance to surface. The cache computes the registry fingerprint
+	// on the worker threads.
+	GlslCache cache {};
+	BatchCompiler compiler {reg, std::max(std::thread::hardware_concurrency(), 4u)};
+	for(uint32_t round = 0; round < 8; ++round) {
+		compiler.SetGlslCache((round % 2 == 0) ? nullptr : &cache);
+		std::vector<uint32_t> numResults(items.size(), 0);
+		auto stats = compiler.CompileBatch(items, [&](Result &&result) {
+			auto &ref = expected[result.itemIndex];
+			++numResults[result.itemIndex];
+			assert(result.success == ref.success);
+			assert(result.glslHeader == ref.glslHeader);
+			assert(result.glslBody == ref.glslBody);
+		});
+		assert(std::all_of(numResults.begin(), numResults.end(), [](uint32_t n) { return n == 1; }));
+		assert(stats.numSucceeded == numGraphs && stats.numFailed == 1);
+		std::cout << "Round " << round << ": " << stats.GetItemsPerSecond() << " graphs/s on " << stats.threadCount << " threads" << std::endl;
+	}
+	assert(!expected[missingItemIdx].success);
+	assert(expected.back().glslBody == expected[1].glslBody);
+	std::cout << "Expected error: " << expected[missingItemIdx].error << std::endl;
+
+	std::error_code ec;
+	for(auto &item : items) {
+		if(!item.filePath.empty())
+			std::filesystem::remove(item.filePath, ec);
+	}
+}
+
+void BatchCompiler::Benchmark(uint32_t graphCount, uint32_t nodeCount)
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+
+	std::vector<std::unique_ptr<Graph>> graphs;
+	std::vector<Item> items;
+	graphs.reserve(graphCount);
+	items.reserve(graphCount);
+	for(uint32_t i = 0; i < graphCount; ++i) {
+		graphs.push_back(std::make_unique<Graph>(reg));
+		Graph::BuildRandomGraph(*graphs.back(), nodeCount, i);
+		items.push_back({graphs.back().get()});
+	}
+
+	auto benchmark = [&](uint32_t threadCount) {
+		BatchCompiler compiler {reg, threadCount};
+		size_t codeSize = 0;
+		auto stats = compiler.CompileBatch(items, [&codeSize](Result &&result) { codeSize += result.glslHeader.size() + result.glslBody.size(); });
+		std::chrono::duration<double, std::milli> dtMax = stats.maxItemTime;
+		std::chrono::duration<double, std::milli> dtAvg = stats.totalItemTime / std::max<size_t>(graphCount, 1);
+		std::cout << stats.threadCount << " thread(s): " << stats.GetItemsPerSecond() << " graphs/s, " << dtAvg.count() << " ms average, " << dtMax.count() << " ms max per graph, " << codeSize << " bytes, "
+		          << stats.numFailed << " failed" << std::endl;
+		return stats;
+	};
+	std::cout << "Compiling " << graphCount << " graphs with " << nodeCount << " nodes each\n";
+	auto serial = benchmark(1);
+	auto parallel = benchmark(0);
+	std::cout << "Speedup: " << (parallel.GetItemsPerSecond() / serial.GetItemsPerSecond()) << "x" << std::endl;
+}
@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+
+module pragma.shadergraph;
+
+import :bytecode;
+
+using namespace pragma::shadergraph;
+
+void BytecodeProgram::Clear()
+{
+	m_instructions.clear();
+	m_operands.clear();
+	m_initialRegisters.clear();
+	m_inputs.clear();
+	m_outputs.clear();
+}
+static const BytecodeProgram::SocketBinding *find_binding(const std::vector<BytecodeProgram::SocketBinding> &bindings, const std::string_view &nodeName, const std::string_view &socketName)
+{
+	auto it = std::find_if(bindings.begin(), bindings.end(), [&nodeName, &socketName](const BytecodeProgram::SocketBinding &binding) { return binding.nodeName == nodeName && binding.socketName == socketName; });
+	return (it != bindings.end()) ? &*it : nullptr;
+}
+const BytecodeProgram::SocketBinding *BytecodeProgram::FindInput(const std::string_view &nodeName, const std::string_view &inputName) const { return find_binding(m_inputs, nodeName, inputName); }
+const BytecodeProgram::SocketBinding *BytecodeProgram::FindOutput(const std::string_view &nodeName, const std::string_view &outputName) const { return find_binding(m_outputs, nodeName, outputName); }
+
+BytecodeInterpreter::BytecodeInterpreter(const BytecodeProgram &program) : m_program {program} { Reset(); }
+void BytecodeInterpreter::Reset() { m_registers = m_program.GetInitialRegisters(); }
+void BytecodeInterpreter::Execute()
+{
+	auto *registers = m_registers.data();
+	auto *operands = m_program.GetOperands().data();
+	for(auto &instr : m_program.GetInstructions()) {
+		auto *inputs = operands + instr.firstOperand;
+		instr.node->EvaluateKernel(KernelArgs {instr.variant, registers, inputs, inputs + instr.numInputs});
+	}
+}
+
+BytecodeBatchInterpreter::BytecodeBatchInterpreter(const BytecodeProgram &program, uint32_t laneCount) : m_program {program}, m_laneCount {laneCount}, m_laneStride {kernel::simd::get_padded_lane_count(laneCount)} { Reset(); }
+void BytecodeBatchInterpreter::Reset()
+{
+	auto &initialRegisters = m_program.GetInitialRegisters();
+	m_registers.resize(initialRegisters.size() * m_laneStride);
+	for(size_t i = 0; i < initialRegisters.size(); ++i) {
+		auto *stream = m_registers.data() + i * m_laneStride;
+		std::fill(stream, stream + m_laneStride, initialRegisters[i]);
+	}
+}
+void BytecodeBatchInterpreter::Execute()
+{
+	auto *registers = m_registers.data();
+	auto *operands = m_program.GetOperands().data();
+	for(auto &instr : m_program.GetInstructions()) {
+		auto *inputs = operands + instr.firstOperand;
+		instr.node->EvaluateKernelBatch(BatchKernelArgs {instr.variant, registers, m_laneStride, inputs, inputs + instr.numInputs});
+	}
+}
+float *BytecodeBatchInterpreter::GetInputStream(const std::string_view &nodeName, const std::string_view &inputName, uint32_t component)
+{
+	auto *binding = m_program.FindInput(nodeName, inputName);
+	if(!binding || component >= get_register_count(binding->type))
+		return nullptr;
+	return GetRegisterStream(binding->reg + component);
+}
+const float *BytecodeBatchInterpreter::GetOutputStream(const std::string_view &nodeName, const std::string_view &outputName, uint32_t component) const
+{
+	auto *binding = m_program.FindOutput(nodeName, outputName);
+	if(!binding || component >= get_register_count(binding->type))
+		return nullptr;
+	return GetRegisterStream(binding->reg + component);
+}
+
+void BytecodeBatchInterpreter::Benchmark(uint32_t width, uint32_t height)
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+	reg->RegisterNode<VectorMathNode>("vector_math");
+	reg->RegisterNode<CombineXyzNode>("combine_xyz");
+
+	// Procedural tile pattern: pow(dot(normalize(fract(vec3(u *8, v *8, 1))), l), 8)
+	Graph graph {reg};
+	auto scaleU = graph.AddNode("math");
+	auto scaleV = graph.AddNode("math");
+	for(auto &node : {scaleU, scaleV}) {
+		node->SetInputValue(MathNode::IN_OPERATION, MathNode::Operation::Multiply);
+		node->SetInputValue(MathNode::IN_VALUE2, 8.f);
+	}
+	auto combine = graph.AddNode("combine_xyz");
+	combine->SetInputValue(CombineXyzNode::IN_Z, 1.f);
+	scaleU->Link(MathNode::OUT_VALUE, *combine, CombineXyzNode::IN_X);
+	scaleV->Link(MathNode::OUT_VALUE, *combine, CombineXyzNode::IN_Y);
+
+	auto fraction = graph.AddNode("vector_math");
+	fraction->SetInputValue(VectorMathNode::IN_OPERATION, VectorMathNode::Operation::Fraction);
+	combine->Link(CombineXyzNode::OUT_VECTOR, *fraction, VectorMathNode::IN_VECTOR1);
+
+	auto normalize = graph.AddNode("vector_math");
+	normalize->SetInputValue(VectorMathNode::IN_OPERATION, VectorMathNode::Operation::Normalize);
+	fraction->Link(VectorMathNode::OUT_VECTOR, *normalize, VectorMathNode::IN_VECTOR1);
+
+	auto dot = graph.AddNode("vector_math");
+	dot->SetInputValue(VectorMathNode::IN_OPERATION, VectorMathNode::Operation::DotProduct);
+	dot->SetInputValue(VectorMathNode::IN_VECTOR2, Vector3 {0.57735f, 0.57735f, 0.57735f});
+	normalize->Link(VectorMathNode::OUT_VECTOR, *dot, VectorMathNode::IN_VECTOR1);
+
+	auto power = graph.AddNode("math");
+	power->SetInputValue(MathNode::IN_OPERATION, MathNode::Operation::Power);
+	power->SetInputValue(MathNode::IN_VALUE2, 8.f);
+	power->SetInputValue(MathNode::IN_CLAMP, true);
+	dot->Link(VectorMathNode::OUT_VALUE, *power, MathNode::IN_VALUE1);
+
+	BytecodeProgram program;
+	std::string err;
+	if(!graph.CompileBytecode(program, err)) {
+		std::cout << "Failed to compile bytecode: " << err << std::endl;
+		return;
+	}
+	auto *inU = program.FindInput(scaleU->GetName(), MathNode::IN_VALUE1);
+	auto *inV = program.FindInput(scaleV->GetName(), MathNode::IN_VALUE1);
+	auto *out = program.FindOutput(power->GetName(), MathNode::OUT_VALUE);
+	assert(inU && inV && out);
+
+	auto numPixels = static_cast<size_t>(width) * height;
+	std::vector<float> scalarResult(numPixels);
+	std::vector<float> batchResult(numPixels);
+
+	BytecodeInterpreter scalar {program};
+	auto t = std::chrono::steady_clock::now();
+	auto *registers = scalar.GetRegisters();
+	for(uint32_t y = 0; y < height; ++y) {
+		for(uint32_t x = 0; x < width; ++x) {
+			registers[inU->reg] = x / static_cast<float>(width);
+			registers[inV->reg] = y / static_cast<float>(height);
+			scalar.Execute();
+			scalarResult[y * width + x] = registers[out->reg];
+		}
+	}
+	std::chrono::duration<double> dtScalar = std::chrono::steady_clock::now() - t;
+
+	// One row per batch
+	BytecodeBatchInterpreter batch {program, width};
+	t = std::chrono::steady_clock::now();
+	auto *streamU = batch.GetRegisterStream(inU->reg);
+	auto *streamV = batch.GetRegisterStream(inV->reg);
+	auto *streamOut = batch.GetRegisterStream(out->reg);
+	for(uint32_t y = 0; y < height; ++y) {
+		for(uint32_t x = 0; x < width; ++x) {
+			streamU[x] = x / static_cast<float>(width);
+			streamV[x] = y / static_cast<float>(height);
+		}
+		batch.Execute();
+		std::copy(streamOut, streamOut + width, batchResult.data() + y * width);
+	}
+	std::chrono::duration<double> dtBatch = std::chrono::steady_clock::now() - t;
+
+	auto maxDeviation = 0.f;
+	for(size_t i = 0; i < numPixels; ++i)
+		maxDeviation = std::max(maxDeviation, std::abs(scalarResult[i] - batchResult[i]));
+	std::cout << "Evaluated " << numPixels << " pixels (" << width << "x" << height << ", " << program.GetInstructions().size() << " instructions)\n";
+	std::cout << "Scalar:  " << (numPixels / dtScalar.count()) << " pixels/s\n";
+	std::cout << "Batched: " << (numPixels / dtBatch.count()) << " pixels/s (" << kernel::simd::INSTRUCTION_SET << ", SIMD width " << kernel::simd::WIDTH << ")\n";
+	std::cout << "Speedup: " << (dtScalar.count() / dtBatch.count()) << "x, max. deviation: " << maxDeviation << std::endl;
+}
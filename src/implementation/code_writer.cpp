@@ -0,0 +1,326 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+module pragma.shadergraph;
+
+import :code_writer;
+import :nodes.math;
+
+using namespace pragma::shadergraph;
+
+static uint32_t find_input_index(const GraphNode &node, const std::string_view &inputName)
+{
+	auto idx = node.node.FindInputIndex(inputName);
+	if(!idx)
+		throw std::invalid_argument {"No input named '" + std::string {inputName} + "' exists!"};
+	return *idx;
+}
+static uint32_t find_output_index(const GraphNode &node, const std::string_view &outputName)
+{
+	auto idx = node.node.FindOutputIndex(outputName);
+	if(!idx)
+		throw std::invalid_argument {"No output named '" + std::string {outputName} + "' exists!"};
+	return *idx;
+}
+glsl::InputNameOrValue::InputNameOrValue(const GraphNode &node, const std::string_view &inputName) : InputNameOrValue {node, find_input_index(node, inputName)} {}
+glsl::ConstantValue::ConstantValue(const GraphNode &node, const std::string_view &inputName) : ConstantValue {node, find_input_index(node, inputName)} {}
+glsl::OutputVarName::OutputVarName(const GraphNode &node, const std::string_view &outputName) : OutputVarName {node, find_output_index(node, outputName)} {}
+glsl::OutputDeclaration::OutputDeclaration(const GraphNode &node, const std::string_view &outputName) : OutputDeclaration {node, find_output_index(node, outputName)} {}
+
+CodeWriter &CodeWriter::operator<<(float value)
+{
+	std::array<char, 32> buf;
+	auto [end, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+	std::string_view str {buf.data(), static_cast<size_t>(end - buf.data())};
+	m_buffer.append(str);
+	// e.g. "1" would be an integer literal
+	if(str.find_first_of(".en") == std::string_view::npos)
+		m_buffer.append(".0");
+	return *this;
+}
+CodeWriter &CodeWriter::operator<<(const glsl::InputNameOrValue &ref)
+{
+	auto &input = ref.node.inputs.at(ref.inputIdx);
+	if(input.link && input.link->parent)
+		return *this << glsl::OutputVarName {*input.link->parent, input.link->outputIndex};
+	return *this << glsl::ConstantValue {ref.node, ref.inputIdx};
+}
+CodeWriter &CodeWriter::operator<<(const glsl::ConstantValue &ref)
+{
+	auto &input = ref.node.inputs.at(ref.inputIdx);
+	visit(input.GetSocket().type, [this, &input](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_data_type<T>() && !std::is_same_v<T, udm::String>) {
+			T v;
+			if(!input.GetValue(v))
+				throw std::invalid_argument {"Failed to retrieve input value!"};
+			WriteGlslValue<T>(v);
+		}
+		else
+			throw std::invalid_argument {"Socket type '" + std::string {magic_enum::enum_name(input.GetSocket().type)} + "' cannot be converted to GLSL!"};
+	});
+	return *this;
+}
+CodeWriter &CodeWriter::operator<<(const glsl::OutputVarName &ref) { return *this << ref.node.GetOutputVarName(ref.outputIdx); }
+CodeWriter &CodeWriter::operator<<(const glsl::OutputDeclaration &ref)
+{
+	auto *output = ref.node.node.GetOutput(ref.outputIdx);
+	if(!output)
+		throw std::invalid_argument {"Output index out of range!"};
+	return *this << to_glsl_type(output->type) << ' ' << glsl::OutputVarName {ref.node, ref.outputIdx};
+}
+CodeWriter &CodeWriter::operator<<(const glsl::VarName &ref) { return *this << ref.node.GetBaseVarName() << '_' << ref.name; }
+
+// Code generation of a math node prior to the introduction of the CodeWriter (and socket handles). The helpers reproduce the
+// previous GraphNode/Node accessors, which looked up the sockets by name and returned a new string for every identifier and literal.
+static std::string get_output_var_name_legacy(const GraphNode &gn, size_t outputIdx) { return std::string {gn.GetBaseVarName()} + "_" + util::to_string(outputIdx); }
+static std::string get_output_var_name_legacy(const GraphNode &gn, const std::string_view &name)
+{
+	auto it = std::find_if(gn.outputs.begin(), gn.outputs.end(), [&name](const OutputSocket &output) { return output.GetSocket().name == name; });
+	if(it == gn.outputs.end())
+		throw std::invalid_argument {"No output named '" + std::string {name} + "' exists!"};
+	return get_output_var_name_legacy(gn, it - gn.outputs.begin());
+}
+static std::string get_glsl_output_declaration_legacy(const GraphNode &gn, const std::string_view &name)
+{
+	auto outputIdx = gn.node.FindOutputIndex(name);
+	if(!outputIdx)
+		throw std::invalid_argument {"No output named '" + std::string {name} + "' exists!"};
+	auto &output = gn.node.GetOutputs()[*outputIdx];
+	return std::string {to_glsl_type(output.type)} + " " + get_output_var_name_legacy(gn, output.name);
+}
+static std::string get_constant_value_legacy(const GraphNode &gn, uint32_t inputIdx)
+{
+	std::string val;
+	auto &input = gn.inputs.at(inputIdx);
+	visit(input.GetSocket().type, [&input, &val](auto tag) {
+		using T = typename decltype(tag)::type;
+		if constexpr(is_data_type<T>() && !std::is_same_v<T, udm::String>) {
+			T v;
+			if(!input.GetValue(v))
+				throw std::invalid_argument {"Failed to retrieve input value!"};
+			val = to_glsl_value<T>(v);
+		}
+		else
+			throw std::invalid_argument {"Socket type '" + std::string {magic_enum::enum_name(input.GetSocket().type)} + "' cannot be converted to GLSL!"};
+	});
+	return val;
+}
+static std::string get_input_name_or_value_legacy(const GraphNode &gn, const std::string_view &inputName)
+{
+	auto &inputs = gn.node.GetInputs();
+	auto it = std::find_if(inputs.begin(), inputs.end(), [&inputName](const Socket &socket) { return socket.name == inputName; });
+	if(it == inputs.end())
+		throw std::invalid_argument {"No input named '" + std::string {inputName} + "' exists!"};
+	auto &input = gn.inputs.at(it - inputs.begin());
+	if(input.link && input.link->parent)
+		return get_output_var_name_legacy(*input.link->parent, input.link->outputIndex);
+	return get_constant_value_legacy(gn, it - inputs.begin());
+}
+
+static std::string evaluate_math_node_legacy(const GraphNode &gn)
+{
+	std::ostringstream code;
+	code << get_glsl_output_declaration_legacy(gn, MathNode::OUT_VALUE) << " = ";
+	auto v1 = get_input_name_or_value_legacy(gn, MathNode::IN_VALUE1);
+	auto v2 = get_input_name_or_value_legacy(gn, MathNode::IN_VALUE2);
+	auto v3 = get_input_name_or_value_legacy(gn, MathNode::IN_VALUE3);
+	auto op = *gn.GetConstantInputValue<MathNode::Operation>(std::string_view {MathNode::IN_OPERATION});
+	using Operation = MathNode::Operation;
+	switch(op) {
+	case Operation::Add:
+		code << v1 << " + " << v2;
+		break;
+	case Operation::Subtract:
+		code << v1 << " - " << v2;
+		break;
+	case Operation::Multiply:
+		code << v1 << " * " << v2;
+		break;
+	case Operation::Divide:
+		code << v1 << " / " << v2;
+		break;
+	case Operation::MultiplyAdd:
+		code << v1 << " * " << v2 << " + " << v3;
+		break;
+	case Operation::Sine:
+		code << "sin(" << v1 << ")";
+		break;
+	case Operation::Cosine:
+		code << "cos(" << v1 << ")";
+		break;
+	case Operation::Tangent:
+		code << "tan(" << v1 << ")";
+		break;
+	case Operation::SinH:
+		code << "sinh(" << v1 << ")";
+		break;
+	case Operation::CosH:
+		code << "cosh(" << v1 << ")";
+		break;
+	case Operation::TanH:
+		code << "tanh(" << v1 << ")";
+		break;
+	case Operation::ArcSine:
+		code << "asin(" << v1 << ")";
+		break;
+	case Operation::ArcCosine:
+		code << "acos(" << v1 << ")";
+		break;
+	case Operation::ArcTangent:
+		code << "atan(" << v1 << ")";
+		break;
+	case Operation::Power:
+		code << "pow(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::Logarithm:
+		code << "log(" << v1 << ")";
+		break;
+	case Operation::Minimum:
+		code << "min(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::Maximum:
+		code << "max(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::Round:
+		code << "round(" << v1 << ")";
+		break;
+	case Operation::LessThan:
+		code << "max(sign(" << v2 << " -" << v1 << "), 0.0)";
+		break;
+	case Operation::GreaterThan:
+		code << "max(sign(" << v1 << " -" << v2 << "), 0.0)";
+		break;
+	case Operation::Modulo:
+		code << "mod(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::FlooredModulo:
+		code << "floored_modulo(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::Absolute:
+		code << "abs(" << v1 << ")";
+		break;
+	case Operation::ArcTan2:
+		code << "atan(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::Floor:
+		code << "floor(" << v1 << ")";
+		break;
+	case Operation::Ceil:
+		code << "ceil(" << v1 << ")";
+		break;
+	case Operation::Fraction:
+		code << "fract(" << v1 << ")";
+		break;
+	case Operation::Trunc:
+		code << "trunc(" << v1 << ")";
+		break;
+	case Operation::Snap:
+		code << "floor(" << v1 << " /" << v2 << ") *" << v2;
+		break;
+	case Operation::Wrap:
+		code << "wrap(" << v1 << ", " << v2 << ", " << v3 << ")";
+		break;
+	case Operation::PingPong:
+		code << "pingpong(" << v1 << ", " << v2 << ")";
+		break;
+	case Operation::Sqrt:
+		code << "sqrt(" << v1 << ")";
+		break;
+	case Operation::InverseSqrt:
+		code << "inversesqrt(" << v1 << ")";
+		break;
+	case Operation::Sign:
+		code << "sign(" << v1 << ")";
+		break;
+	case Operation::Exponent:
+		code << "exp(" << v1 << ")";
+		break;
+	case Operation::Radians:
+		code << "radians(" << v1 << ")";
+		break;
+	case Operation::Degrees:
+		code << "degrees(" << v1 << ")";
+		break;
+	case Operation::SmoothMin:
+		code << "smoothmin(" << v1 << ", " << v2 << ", " << v3 << ")";
+		break;
+	case Operation::SmoothMax:
+		code << "-smoothmin(-" << v1 << ", -" << v2 << ", " << v3 << ")";
+		break;
+	case Operation::Compare:
+		code << "((abs(" << v1 << " -" << v2 << ") <= max(" << v3 << ", FLT_EPSILON))) ? 1.0 : 0.0";
+		break;
+	}
+	code << ";\n";
+
+	auto clamp = get_input_name_or_value_legacy(gn, MathNode::IN_CLAMP);
+	auto constClamp = gn.GetConstantInputValue<bool>(std::string_view {MathNode::IN_CLAMP});
+	if(!constClamp.has_value() || *constClamp) {
+		auto outVarName = get_output_var_name_legacy(gn, MathNode::OUT_VALUE);
+		code << outVarName << " = (" << clamp << " > 0.5) ? clamp(" << outVarName << ", 0.0, 1.0) : " << outVarName << ";\n";
+	}
+	return code.str();
+}
+
+void CodeWriter::Benchmark(uint32_t nodeCount, uint32_t iterations)
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+
+	// Chain of alternating additions and multiplications, every fourth node is clamped
+	Graph graph {reg};
+	std::vector<GraphNode *> nodes;
+	nodes.reserve(nodeCount);
+	for(uint32_t i = 0; i < nodeCount; ++i) {
+		auto node = graph.AddNode("math");
+		node->SetInputValue(MathNode::IN_OPERATION, (i % 2 == 0) ? MathNode::Operation::Add : MathNode::Operation::Multiply);
+		node->SetInputValue(MathNode::IN_VALUE2, 0.5f + static_cast<float>(i % 7));
+		node->SetInputValue(MathNode::IN_CLAMP, i % 4 == 0);
+		if(!nodes.empty())
+			nodes.back()->Link(MathNode::OUT_VALUE, *node, MathNode::IN_VALUE1);
+		nodes.push_back(node.get());
+	}
+
+	// Previous code generation: Every node returned a new string, which was then copied into the output stream (see Graph::GenerateGlsl)
+	size_t legacySize = 0;
+	auto t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i) {
+		std::ostringstream body;
+		for(auto *node : nodes) {
+			body << "// " << node->GetName() << " (" << (*node)->GetType() << ")\n";
+			body << evaluate_math_node_legacy(*node);
+			body << "\n";
+		}
+		legacySize = body.str().size();
+	}
+	std::chrono::duration<double> dtLegacy = std::chrono::steady_clock::now() - t;
+
+	CodeWriter writer;
+	auto generate = [&]() {
+		writer.Clear();
+		for(auto *node : nodes) {
+			writer << "// " << node->GetName() << " (" << (*node)->GetType() << ")\n";
+			node->node.Evaluate(graph, *node, writer);
+			writer << "\n";
+		}
+	};
+	t = std::chrono::steady_clock::now();
+	generate();
+	std::chrono::duration<double> dtFirst = std::chrono::steady_clock::now() - t;
+
+	t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i)
+		generate();
+	std::chrono::duration<double> dtWriter = std::chrono::steady_clock::now() - t;
+
+	// The sizes differ slightly, since the writer always writes floats as float literals (e.g. "1.0" instead of "1")
+	auto numNodes = static_cast<double>(nodeCount) * iterations;
+	std::cout << "Generated code for " << nodeCount << " nodes " << iterations << " times\n";
+	std::cout << "std::ostringstream:        " << (numNodes / dtLegacy.count()) << " nodes/s (" << legacySize << " bytes)\n";
+	std::cout << "CodeWriter (first pass):   " << (nodeCount / dtFirst.count()) << " nodes/s\n";
+	std::cout << "CodeWriter (re-used):      " << (numNodes / dtWriter.count()) << " nodes/s (" << writer.GetSize() << " bytes)\n";
+	std::cout << "Speedup: " << (dtLegacy.count() / dtWriter.count()) << "x" << std::endl;
+}
@@ -0,0 +1,190 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+module pragma.shadergraph;
+
+import :compiled_graph;
+import :graph;
+import :nodes.math;
+
+using namespace pragma::shadergraph;
+
+CompiledGraph::CompiledGraph(const Graph &graph) { Build(graph); }
+
+void CompiledGraph::Build(const Graph &graph)
+{
+	auto &nodes = graph.GetNodes();
+	auto numNodes = nodes.size();
+	m_nodes.clear();
+	m_inputOffsets.clear();
+	m_outputOffsets.clear();
+	m_nodes.reserve(numNodes);
+	m_inputOffsets.reserve(numNodes + 1);
+	m_outputOffsets.reserve(numNodes + 1);
+	m_inputOffsets.push_back(0);
+	m_outputOffsets.push_back(0);
+	for(auto &node : nodes) {
+		m_nodes.push_back(node.get());
+		m_inputOffsets.push_back(m_inputOffsets.back() + node->inputs.size());
+		m_outputOffsets.push_back(m_outputOffsets.back() + node->outputs.size());
+	}
+
+	// Producers of the inputs. The consumers are counted at the same time, since the output links
+	// of a view are incomplete.
+	// The count of output slot j is stored at j +2, so that after the prefix sum m_consumerOffsets[j +1] is the start of slot j
+	// and can be used as its insertion cursor. Once all consumers have been inserted, it is the end of slot j.
+	m_inputLinks.assign(m_inputOffsets.back(), {});
+	m_consumerOffsets.assign(m_outputOffsets.back() + 2, 0);
+	for(size_t i = 0; i < numNodes; ++i) {
+		auto *inputLinks = m_inputLinks.data() + m_inputOffsets[i];
+		for(auto &input : nodes[i]->inputs) {
+			auto &ref = inputLinks[input.inputIndex];
+			if(!input.link || !input.link->parent)
+				continue;
+			ref = {input.link->parent->nodeIndex, input.link->outputIndex};
+			++m_consumerOffsets[m_outputOffsets[ref.node] + ref.socket + 2];
+		}
+	}
+	for(size_t i = 1; i < m_consumerOffsets.size(); ++i)
+		m_consumerOffsets[i] += m_consumerOffsets[i - 1];
+
+	m_consumers.resize(m_consumerOffsets.back());
+	for(uint32_t i = 0; i < numNodes; ++i) {
+		auto inputLinks = GetInputLinks(i);
+		for(uint32_t j = 0; j < inputLinks.size(); ++j) {
+			auto &ref = inputLinks[j];
+			if(ref.node == INVALID_INDEX)
+				continue;
+			m_consumers[m_consumerOffsets[m_outputOffsets[ref.node] + ref.socket + 1]++] = {i, j};
+		}
+	}
+	m_consumerOffsets.pop_back();
+}
+
+std::vector<bool> CompiledGraph::FindLiveNodes() const
+{
+	auto numNodes = GetNodeCount();
+	std::vector<bool> live(numNodes, false);
+	std::vector<uint32_t> stack;
+	for(uint32_t i = 0; i < numNodes; ++i) {
+		if(!GetNodeType(i).IsOutputNode())
+			continue;
+		live[i] = true;
+		stack.push_back(i);
+	}
+	if(stack.empty()) {
+		live.assign(numNodes, true);
+		return live;
+	}
+	while(!stack.empty()) {
+		auto nodeIdx = stack.back();
+		stack.pop_back();
+		for(auto &ref : GetInputLinks(nodeIdx)) {
+			if(ref.node == INVALID_INDEX || live[ref.node])
+				continue;
+			live[ref.node] = true;
+			stack.push_back(ref.node);
+		}
+	}
+	return live;
+}
+
+bool CompiledGraph::TopologicalSort(std::vector<uint32_t> &outOrder, const std::vector<bool> *mask) const
+{
+	std::vector<uint32_t> scratch;
+	return TopologicalSort(outOrder, scratch, mask);
+}
+bool CompiledGraph::TopologicalSort(std::vector<uint32_t> &outOrder, std::vector<uint32_t> &scratch, const std::vector<bool> *mask) const
+{
+	auto numNodes = GetNodeCount();
+	auto isIncluded = [mask](uint32_t nodeIdx) { return !mask || (*mask)[nodeIdx]; };
+	auto &inDegree = scratch;
+	inDegree.assign(numNodes, 0);
+	uint32_t numIncluded = 0;
+	for(uint32_t i = 0; i < numNodes; ++i) {
+		if(!isIncluded(i))
+			continue;
+		++numIncluded;
+		for(auto &ref : GetInputLinks(i)) {
+			// Links to nodes that aren't part of the set are irrelevant for the order
+			if(ref.node != INVALID_INDEX && isIncluded(ref.node))
+				++inDegree[i];
+		}
+	}
+
+	// The output vector doubles as the queue
+	outOrder.clear();
+	outOrder.reserve(numIncluded);
+	for(uint32_t i = 0; i < numNodes; ++i) {
+		if(isIncluded(i) && inDegree[i] == 0)
+			outOrder.push_back(i);
+	}
+	for(size_t head = 0; head < outOrder.size(); ++head) {
+		for(auto &ref : GetConsumers(outOrder[head])) {
+			if(isIncluded(ref.node) && --inDegree[ref.node] == 0)
+				outOrder.push_back(ref.node);
+		}
+	}
+	return outOrder.size() == numIncluded;
+}
+
+void CompiledGraph::Benchmark(uint32_t nodeCount, uint32_t iterations)
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+
+	// Every node is linked to two arbitrary nodes that were added before it
+	Graph graph {reg};
+	Graph::BuildRandomGraph(graph, nodeCount, 123, 1.f);
+	auto &nodes = graph.GetNodes();
+
+	auto t = std::chrono::steady_clock::now();
+	CompiledGraph compiled;
+	for(uint32_t i = 0; i < iterations; ++i)
+		compiled.Build(graph);
+	std::chrono::duration<double> dtBuild = std::chrono::steady_clock::now() - t;
+
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> scratch;
+	t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i)
+		compiled.TopologicalSort(order, scratch);
+	std::chrono::duration<double> dtSort = std::chrono::steady_clock::now() - t;
+
+	// Longest path to each node, which visits every link once
+	std::vector<uint32_t> depthsPtr(nodeCount);
+	t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i) {
+		for(auto nodeIdx : order) {
+			uint32_t depth = 0;
+			for(auto &input : nodes[nodeIdx]->inputs) {
+				if(input.link && input.link->parent)
+					depth = std::max(depth, depthsPtr[input.link->parent->nodeIndex] + 1);
+			}
+			depthsPtr[nodeIdx] = depth;
+		}
+	}
+	std::chrono::duration<double> dtPtr = std::chrono::steady_clock::now() - t;
+
+	std::vector<uint32_t> depthsCsr(nodeCount);
+	t = std::chrono::steady_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i) {
+		for(auto nodeIdx : order) {
+			uint32_t depth = 0;
+			for(auto &ref : compiled.GetInputLinks(nodeIdx)) {
+				if(ref.node != INVALID_INDEX)
+					depth = std::max(depth, depthsCsr[ref.node] + 1);
+			}
+			depthsCsr[nodeIdx] = depth;
+		}
+	}
+	std::chrono::duration<double> dtCsr = std::chrono::steady_clock::now() - t;
+
+	std::cout << "Compiled graph with " << nodeCount << " nodes and " << compiled.GetLinkCount() << " links\n";
+	std::cout << "Build: " << (dtBuild.count() / iterations * 1'000.0) << " ms, sort: " << (dtSort.count() / iterations * 1'000.0) << " ms\n";
+	std::cout << "Traversal via socket pointers: " << (dtPtr.count() / iterations * 1'000.0) << " ms\n";
+	std::cout << "Traversal via CSR arrays:      " << (dtCsr.count() / iterations * 1'000.0) << " ms\n";
+	std::cout << "Speedup: " << (dtPtr.count() / dtCsr.count()) << "x, results " << ((depthsPtr == depthsCsr) ? "match" : "DIFFER") << std::endl;
+}
@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+module pragma.shadergraph;
+
+import :glsl_cache;
+
+using namespace pragma::shadergraph;
+
+GlslCache::Key GlslCache::ComputeKey(const Graph &graph, const std::optional<std::string> &namePrefix)
+{
+	// The generated code contains the node names and the variable names, which are derived from the node indices,
+	// so the structural hash alone isn't sufficient.
+	auto h = graph.GetLayoutHash();
+	h = hash::hash_combine(h, graph.GetNodeRegistry()->GetFingerprint());
+	if(namePrefix)
+		h = hash::hash_string(*namePrefix, hash::hash_combine(h, 1));
+	return h;
+}
+
+GlslCache::GlslCache(size_t maxBytes) : m_maxBytes {maxBytes} {}
+
+void GlslCache::GenerateGlsl(const Graph &graph, std::ostream &outHeader, std::ostream &outBody, const std::optional<std::string> &namePrefix)
+{
+	auto key = ComputeKey(graph, namePrefix);
+	auto entry = Find(key);
+	if(!entry) {
+		// Disk access and code generation happen outside of the lock, so other threads aren't blocked in the meantime
+		auto cacheDir = GetCacheDirectory();
+		if(cacheDir) {
+			entry = LoadFromDisk(*cacheDir, key);
+			if(entry) {
+				std::scoped_lock lock {m_mutex};
+				++m_stats.diskHits;
+			}
+		}
+		if(!entry) {
+			std::ostringstream header, body;
+			graph.GenerateGlsl(header, body, namePrefix);
+			auto newEntry = std::make_shared<Entry>();
+			newEntry->header = header.str();
+			newEntry->body = body.str();
+			if(cacheDir && SaveToDisk(*cacheDir, key, *newEntry)) {
+				std::scoped_lock lock {m_mutex};
+				++m_stats.diskWrites;
+			}
+			entry = newEntry;
+		}
+		Insert(key, entry);
+	}
+	outHeader << entry->header;
+	outBody << entry->body;
+}
+
+std::shared_ptr<const GlslCache::Entry> GlslCache::Find(Key key)
+{
+	std::scoped_lock lock {m_mutex};
+	auto it = m_keyToEntry.find(key);
+	if(it == m_keyToEntry.end()) {
+		++m_stats.misses;
+		return nullptr;
+	}
+	++m_stats.hits;
+	m_entryList.splice(m_entryList.begin(), m_entryList, it->second);
+	return it->second->second;
+}
+
+void GlslCache::Insert(Key key, const std::shared_ptr<const Entry> &entry)
+{
+	std::scoped_lock lock {m_mutex};
+	auto it = m_keyToEntry.find(key);
+	if(it != m_keyToEntry.end())
+		EraseEntry(it->second);
+	m_entryList.emplace_front(key, entry);
+	m_keyToEntry[key] = m_entryList.begin();
+	m_stats.byteSize += entry->GetByteSize();
+	++m_stats.entryCount;
+	EvictEntries();
+}
+
+bool GlslCache::Erase(Key key)
+{
+	std::scoped_lock lock {m_mutex};
+	auto it = m_keyToEntry.find(key);
+	if(it == m_keyToEntry.end())
+		return false;
+	EraseEntry(it->second);
+	return true;
+}
+
+void GlslCache::Clear()
+{
+	std::scoped_lock lock {m_mutex};
+	m_entryList.clear();
+	m_keyToEntry.clear();
+	m_stats.entryCount = 0;
+	m_stats.byteSize = 0;
+}
+
+void GlslCache::SetCacheDirectory(const std::optional<std::filesystem::path> &path)
+{
+	std::scoped_lock lock {m_mutex};
+	m_cacheDirectory = path;
+}
+std::optional<std::filesystem::path> GlslCache::GetCacheDirectory() const
+{
+	std::scoped_lock lock {m_mutex};
+	return m_cacheDirectory;
+}
+
+namespace {
+	constexpr std::array<char, 4> CACHE_FILE_IDENTIFIER {'P', 'S', 'G', 'C'};
+	std::filesystem::path get_cache_file_path(const std::filesystem::path &dir, GlslCache::Key key)
+	{
+		std::array<char, 17> name {};
+		std::snprintf(name.data(), name.size(), "%016llx", static_cast<unsigned long long>(key));
+		return dir / (std::string {name.data()} + "." + GlslCache::CACHE_FILE_EXTENSION);
+	}
+	template<typename T>
+	void write_value(std::ostream &out, const T &value)
+	{
+		out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+	}
+	template<typename T>
+	bool read_value(std::istream &in, T &outValue)
+	{
+		return static_cast<bool>(in.read(reinterpret_cast<char *>(&outValue), sizeof(outValue)));
+	}
+	void write_string(std::ostream &out, const std::string &str)
+	{
+		write_value(out, static_cast<uint64_t>(str.size()));
+		out.write(str.data(), str.size());
+	}
+	// The size is bounded by the number of bytes left in the stream, so a corrupt size can't cause a huge allocation
+	bool read_string(std::istream &in, uint64_t streamSize, std::string &outStr)
+	{
+		uint64_t size;
+		if(!read_value(in, size))
+			return false;
+		auto pos = in.tellg();
+		if(pos < 0 || static_cast<uint64_t>(pos) > streamSize || size > streamSize - static_cast<uint64_t>(pos))
+			return false;
+		outStr.resize(size);
+		return static_cast<bool>(in.read(outStr.data(), size));
+	}
+};
+
+std::shared_ptr<const GlslCache::Entry> GlslCache::LoadFromDisk(const std::filesystem::path &dir, Key key) const
+{
+	// Files from older versions, with a mismatching key or that are corrupt or truncated are treated as a miss and will be overwritten
+	try {
+		std::ifstream in {get_cache_file_path(dir, key), std::ios::binary | std::ios::ate};
+		if(!in)
+			return nullptr;
+		auto fileSize = in.tellg();
+		if(fileSize < 0 || !in.seekg(0))
+			return nullptr;
+		std::array<char, 4> identifier;
+		uint32_t version;
+		Key fileKey;
+		if(!read_value(in, identifier) || identifier != CACHE_FILE_IDENTIFIER || !read_value(in, version) || version != CODE_GENERATOR_VERSION || !read_value(in, fileKey) || fileKey != key)
+			return nullptr;
+		auto entry = std::make_shared<Entry>();
+		if(!read_string(in, fileSize, entry->header) || !read_string(in, fileSize, entry->body))
+			return nullptr;
+		return entry;
+	}
+	catch(const std::exception &) {
+		return nullptr;
+	}
+}
+
+bool GlslCache::SaveToDisk(const std::filesystem::path &dir, Key key, const Entry &entry) const
+{
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+	auto filePath = get_cache_file_path(dir, key);
+	// Written to a uniquely named temporary file first and then renamed, which atomically replaces the target.
+	// Other processes will either see the old file, the new file or no file, but never a partially written one.
+	std::ostringstream tmpName;
+	tmpName << filePath.filename().string() << "." << std::this_thread::get_id() << "." << std::chrono::steady_clock::now().time_since_epoch().count() << "." << std::random_device {}() << ".tmp";
+	auto tmpPath = dir / tmpName.str();
+	{
+		std::ofstream out {tmpPath, std::ios::binary | std::ios::trunc};
+		if(!out)
+			return false;
+		write_value(out, CACHE_FILE_IDENTIFIER);
+		write_value(out, CODE_GENERATOR_VERSION);
+		write_value(out, key);
+		write_string(out, entry.header);
+		write_string(out, entry.body);
+		out.flush();
+		if(!out) {
+			out.close();
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+	}
+	std::filesystem::rename(tmpPath, filePath, ec);
+	if(ec) {
+		std::filesystem::remove(tmpPath, ec);
+		return false;
+	}
+	return true;
+}
+
+void GlslCache::SetMaxBytes(size_t maxBytes)
+{
+	std::scoped_lock lock {m_mutex};
+	m_maxBytes = maxBytes;
+	EvictEntries();
+}
+size_t GlslCache::GetMaxBytes() const
+{
+	std::scoped_lock lock {m_mutex};
+	return m_maxBytes;
+}
+
+GlslCache::Statistics GlslCache::GetStatistics() const
+{
+	std::scoped_lock lock {m_mutex};
+	return m_stats;
+}
+void GlslCache::ResetStatistics()
+{
+	std::scoped_lock lock {m_mutex};
+	m_stats.hits = 0;
+	m_stats.misses = 0;
+	m_stats.evictions = 0;
+	m_stats.diskHits = 0;
+	m_stats.diskWrites = 0;
+}
+
+void GlslCache::EraseEntry(EntryList::iterator it)
+{
+	m_stats.byteSize -= it->second->GetByteSize();
+	--m_stats.entryCount;
+	m_keyToEntry.erase(it->first);
+	m_entryList.erase(it);
+}
+
+void GlslCache::EvictEntries()
+{
+	while(m_stats.byteSize > m_maxBytes && !m_entryList.empty()) {
+		EraseEntry(std::prev(m_entryList.end()));
+		++m_stats.evictions;
+	}
+}
@@ -8,6 +8,8 @@ module;
 module pragma.shadergraph;
 
 import :graph;
+import :code_writer;
+import :compiled_graph;
 import :nodes.math;
 
 using namespace pragma::shadergraph;
@@ -25,12 +27,65 @@ void Graph::Test()
 	node1->SetInputValue(MathNode::IN_OPERATION, MathNode::Operation::Multiply);
 	node0->SetInputValue(MathNode::IN_VALUE1, 1.f);
 	node0->Link(MathNode::OUT_VALUE, *node1, MathNode::IN_VALUE1);
+	// node1 depends on node0, so linking them the other way around would create a cycle
+	assert(!node1->CanLink(MathNode::OUT_VALUE, *node0, MathNode::IN_VALUE2));
 
 	graph.DebugPrint();
 
 	std::ostringstream header, body;
 	graph.GenerateGlsl(header, body);
 	std::cout << "Generated GLSL:\n" << body.str() << std::endl;
+
+	BytecodeProgram program;
+	std::string err;
+	if(!graph.CompileBytecode(program, err))
+		std::cout << "Failed to compile bytecode: " << err << std::endl;
+	else {
+		BytecodeInterpreter interpreter {program};
+		interpreter.SetInputValue(node0->GetName(), MathNode::IN_VALUE2, 2.f);
+		interpreter.Execute();
+		float result;
+		if(interpreter.GetOutputValue(node1->GetName(), MathNode::OUT_VALUE, result))
+			std::cout << "CPU result: " << result << std::endl;
+	}
+
+	// A failed load must leave the graph unchanged. The second file contains a new node followed by a node with a name that
+	// already exists, so the first node has to be removed again, while the topological order of the graph is valid.
+	{
+		auto tmpDir = std::filesystem::temp_directory_path();
+		auto filePath = (tmpDir / ("psg_load_test." + std::string {EXTENSION_BINARY})).string();
+		auto badFilePath = (tmpDir / ("psg_load_test_bad." + std::string {EXTENSION_BINARY})).string();
+		[[maybe_unused]] auto saved = graph.Save(filePath, err);
+		assert(saved);
+		Graph badGraph {reg};
+		auto newNode = badGraph.AddNode("math");
+		auto duplicateNode = badGraph.AddNode("math");
+		newNode->SetName("new_node");
+		duplicateNode->SetName(node1->GetName());
+		newNode->Link(MathNode::OUT_VALUE, *duplicateNode, MathNode::IN_VALUE1);
+		saved = badGraph.Save(badFilePath, err);
+		assert(saved);
+
+		Graph loaded {reg};
+		[[maybe_unused]] auto success = loaded.Load(filePath, err);
+		assert(success);
+		auto layoutHash = loaded.GetLayoutHash();
+		success = loaded.Load(badFilePath, err);
+		assert(!success);
+		std::cout << "Expected error: " << err << std::endl;
+		assert(loaded.GetNodes().size() == graph.GetNodes().size());
+		assert(loaded.GetLayoutHash() == layoutHash);
+		assert(!loaded.GetNode("new_node"));
+		std::ostringstream loadedHeader, loadedBody;
+		loaded.GenerateGlsl(loadedHeader, loadedBody);
+		assert(loadedBody.str() == body.str());
+		// The name counters must have been restored as well
+		assert(loaded.AddNode("math")->GetName() == graph.AddNode("math")->GetName());
+
+		std::error_code ec;
+		std::filesystem::remove(filePath, ec);
+		std::filesystem::remove(badFilePath, ec);
+	}
 	//bool Link(const char *outputName, GraphNode &linkTarget, const char *inputName)
 	//
 	// TODO: Apply operation?
@@ -44,18 +99,160 @@ void Graph::Test()
 	//std::cout << "Generated GLSL:\n" << glslCode << std::endl;
 }
 
+void Graph::BuildRandomGraph(Graph &graph, uint32_t nodeCount, uint32_t seed, float secondLinkProbability)
+{
+	std::mt19937 rng {seed};
+	std::uniform_int_distribution<uint32_t> operationDist {math::to_integral(MathNode::Operation::Add), math::to_integral(MathNode::Operation::Multiply)};
+	std::uniform_real_distribution<float> valueDist {0.f, 10.f};
+	std::bernoulli_distribution secondLinkDist {secondLinkProbability};
+	graph.ReserveNodes(graph.GetNodes().size() + nodeCount);
+	auto firstNodeIdx = graph.GetNodes().size();
+	for(uint32_t i = 0; i < nodeCount; ++i) {
+		auto node = graph.AddNode("math");
+		if(!node)
+			throw std::invalid_argument {"Node type 'math' is not registered!"};
+		node->SetInputValue(MathNode::IN_OPERATION, static_cast<MathNode::Operation>(operationDist(rng)));
+		node->SetInputValue(MathNode::IN_VALUE1, valueDist(rng));
+		node->SetInputValue(MathNode::IN_VALUE2, valueDist(rng));
+		node->SetInputValue(MathNode::IN_VALUE3, valueDist(rng));
+		if(i == 0)
+			continue;
+		std::uniform_int_distribution<size_t> dist {firstNodeIdx, firstNodeIdx + i - 1};
+		auto &nodes = graph.GetNodes();
+		nodes[dist(rng)]->Link(MathNode::OUT_VALUE, *node, MathNode::IN_VALUE1);
+		if(secondLinkDist(rng))
+			nodes[dist(rng)]->Link(MathNode::OUT_VALUE, *node, MathNode::IN_VALUE2);
+	}
+}
+
+void Graph::BenchmarkLoad(uint32_t nodeCount, uint32_t iterations)
+{
+	auto reg = std::make_shared<NodeRegistry>();
+	reg->RegisterNode<MathNode>("math");
+
+	Graph graph {reg};
+	BuildRandomGraph(graph, nodeCount);
+
+	auto tmpDir = std::filesystem::temp_directory_path();
+	auto benchmark = [&](const std::string &extension, uint32_t threadCount) {
+		auto filePath = (tmpDir / ("psg_load_benchmark." + extension)).string();
+		std::string err;
+		if(!graph.Save(filePath, err)) {
+			std::cout << "Failed to save '" << filePath << "': " << err << std::endl;
+			return;
+		}
+		std::error_code ec;
+		auto fileSize = std::filesystem::file_size(filePath, ec);
+		size_t numLoaded = 0;
+		auto t = std::chrono::steady_clock::now();
+		for(uint32_t i = 0; i < iterations; ++i) {
+			Graph loaded {reg};
+			if(!loaded.Load(filePath, err, threadCount)) {
+				std::cout << "Failed to load '" << filePath << "': " << err << std::endl;
+				break;
+			}
+			numLoaded = loaded.GetNodes().size();
+		}
+		std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t;
+		std::filesystem::remove(filePath, ec);
+		std::cout << extension << " (" << ((threadCount == 1) ? "serial" : "parallel") << "): " << (dt.count() / iterations * 1'000.0) << " ms per load, " << fileSize << " bytes, " << numLoaded << " nodes" << std::endl;
+	};
+	std::cout << "Loading graph with " << nodeCount << " nodes " << iterations << " times\n";
+	benchmark(EXTENSION_ASCII, 1);
+	benchmark(EXTENSION_BINARY, 1);
+	benchmark(EXTENSION_BINARY, 0);
+}
+
 Graph::Graph(const Graph &other) : m_nodeRegistry {other.m_nodeRegistry} { Merge(other); }
 
 Graph::Graph(const std::shared_ptr<NodeRegistry> &nodeReg) : m_nodeRegistry {nodeReg} {}
 
+Graph::Graph(ViewTag, const Graph &base) : m_nodeRegistry {base.m_nodeRegistry}, m_nodes {base.m_nodes}, m_typeGroups {base.m_typeGroups}, m_categoryGroups {base.m_categoryGroups}, m_slots {base.m_slots}, m_nodeSlots {base.m_nodeSlots}, m_freeSlots {base.m_freeSlots}, m_nameCounters {base.m_nameCounters}, m_base {&base}
+{
+	// The view starts out with the same topology as its base graph, so the cached order of the base graph can be re-used
+	m_topology = base.GetTopology();
+}
+
+GraphNode &Graph::ResolveNode(GraphNode &node) const
+{
+	if(&node.graph == this || !m_base)
+		return node;
+	return *m_nodes[node.nodeIndex];
+}
+
+GraphNode &Graph::Materialize(GraphNode &node)
+{
+	auto &resolved = ResolveNode(node);
+	if(&resolved.graph == this)
+		return resolved;
+	auto copy = std::make_shared<GraphNode>(*this, node);
+	copy->m_origin = &node;
+	for(auto &input : copy->inputs) {
+		input.parent = copy.get();
+		if(!input.link)
+			continue;
+		auto &producer = ResolveNode(*input.link->parent);
+		if(&producer.graph != this)
+			continue;
+		// The producer has been materialized already, so the link has to be established in both directions
+		auto &output = producer.outputs[input.link->outputIndex];
+		auto it = std::find(output.links.begin(), output.links.end(), &node.inputs[input.inputIndex]);
+		if(it != output.links.end())
+			*it = &input;
+		input.link = &output;
+	}
+	for(auto &output : copy->outputs) {
+		output.parent = copy.get();
+		for(auto *&link : output.links) {
+			auto &consumer = ResolveNode(*link->parent);
+			if(&consumer.graph != this)
+				continue;
+			auto &input = consumer.inputs[link->inputIndex];
+			input.link = &output;
+			link = &input;
+		}
+	}
+	m_nodes[node.nodeIndex] = copy;
+	// The copy has the same links as the original node, so the topology remains valid
+	if(m_topology.compiledValid)
+		m_topology.compiled.UpdateNode(node.nodeIndex, *copy);
+	return *copy;
+}
+
+GraphNode &Graph::MaterializeNeighborhood(GraphNode &node)
+{
+	auto &materialized = Materialize(node);
+	// Materializing a neighbor updates the link pointers of this node, but never the number of links
+	for(auto &input : materialized.inputs) {
+		if(input.link)
+			Materialize(*input.link->parent);
+	}
+	for(auto &output : materialized.outputs) {
+		for(size_t i = 0; i < output.links.size(); ++i)
+			Materialize(*output.links[i]->parent);
+	}
+	return materialized;
+}
+
 void Graph::Clear()
 {
+	// Handles of the cleared nodes must become stale
+	for(auto slot : m_nodeSlots) {
+		m_slots[slot].nodeIndex = NodeHandle::INVALID_SLOT;
+		++m_slots[slot].generation;
+		m_freeSlots.push_back(slot);
+	}
 	m_nodes.clear();
+	m_nodeSlots.clear();
 	m_nameToNodeIndex.clear();
+	m_nameCounters.clear();
+	m_typeGroups.Clear();
+	m_categoryGroups.Clear();
+	InvalidateTopology();
 }
 void Graph::Merge(const Graph &other)
 {
-	m_nodes.reserve(m_nodes.size() + other.m_nodes.size());
+	ReserveNodes(m_nodes.size() + other.m_nodes.size());
 	std::unordered_map<GraphNode *, GraphNode *> oldToNew;
 	oldToNew.reserve(other.m_nodes.size());
 	auto offset = m_nodes.size();
@@ -93,21 +290,89 @@ void Graph::Merge(const Graph &other)
 			input.link = &it->second->outputs[input.link->outputIndex];
 		}
 	}
+	// The links have been copied directly, so the order of the new nodes is unknown
+	InvalidateTopology();
+}
+
+void Graph::NodeGroups::Add(const std::string_view &key, uint32_t nodeIdx)
+{
+	auto &group = groups[key];
+	if(positions.size() <= nodeIdx)
+		positions.resize(nodeIdx + 1);
+	positions[nodeIdx] = group.size();
+	group.push_back(nodeIdx);
+}
+void Graph::NodeGroups::Remove(const std::string_view &key, uint32_t nodeIdx)
+{
+	auto it = groups.find(key);
+	if(it == groups.end())
+		return;
+	auto &group = it->second;
+	auto pos = positions[nodeIdx];
+	group[pos] = group.back();
+	positions[group[pos]] = pos;
+	group.pop_back();
+	// Empty groups are erased, since the node type that owns the key may not exist anymore
+	if(group.empty())
+		groups.erase(it);
+}
+void Graph::NodeGroups::Move(const std::string_view &key, uint32_t oldNodeIdx, uint32_t newNodeIdx)
+{
+	auto pos = positions[oldNodeIdx];
+	groups[key][pos] = newNodeIdx;
+	positions[newNodeIdx] = pos;
+}
+std::span<const uint32_t> Graph::NodeGroups::Find(const std::string_view &key) const
+{
+	auto it = groups.find(key);
+	if(it == groups.end())
+		return {};
+	return it->second;
+}
+void Graph::NodeGroups::Clear()
+{
+	groups.clear();
+	positions.clear();
+}
+
+void Graph::AddToNodeGroups(const GraphNode &node)
+{
+	m_typeGroups.Add(node.node.GetType(), node.nodeIndex);
+	m_categoryGroups.Add(node.node.GetCategory(), node.nodeIndex);
+}
+
+std::vector<std::shared_ptr<GraphNode>> Graph::CollectNodes(std::span<const uint32_t> nodeIndices) const
+{
+	std::vector<uint32_t> sortedIndices {nodeIndices.begin(), nodeIndices.end()};
+	std::sort(sortedIndices.begin(), sortedIndices.end());
+	std::vector<std::shared_ptr<GraphNode>> nodes;
+	nodes.reserve(sortedIndices.size());
+	for(auto nodeIdx : sortedIndices)
+		nodes.push_back(m_nodes[nodeIdx]);
+	return nodes;
 }
 
 std::shared_ptr<GraphNode> Graph::FindNodeByType(const std::string_view &type) const
 {
-	for(const auto &node : m_nodes) {
-		if(node->node.GetType() == type)
-			return node;
-	}
-	return nullptr;
+	auto nodeIndices = m_typeGroups.Find(type);
+	if(nodeIndices.empty())
+		return nullptr;
+	return m_nodes[*std::min_element(nodeIndices.begin(), nodeIndices.end())];
 }
+std::vector<std::shared_ptr<GraphNode>> Graph::FindNodesByType(const std::string_view &type) const { return CollectNodes(m_typeGroups.Find(type)); }
+std::vector<std::shared_ptr<GraphNode>> Graph::FindNodesByCategory(const std::string_view &category) const { return CollectNodes(m_categoryGroups.Find(category)); }
 std::shared_ptr<GraphNode> Graph::GetNode(const std::string &name)
 {
 	auto it = m_nameToNodeIndex.find(name);
-	if(it == m_nameToNodeIndex.end())
+	if(it == m_nameToNodeIndex.end()) {
+		if(m_base) {
+			// Nodes of the base graph are at the same position in the view
+			it = m_base->m_nameToNodeIndex.find(name);
+			if(it != m_base->m_nameToNodeIndex.end())
+				return m_nodes[it->second];
+		}
 		return nullptr;
+	}
 	return m_nodes[it->second];
 }
 bool Graph::RemoveNode(const std::string &name)
@@ -115,35 +380,138 @@ bool Graph::RemoveNode(const std::string &name)
 	auto it = m_nameToNodeIndex.find(name);
 	if(it == m_nameToNodeIndex.end())
 		return false;
-	auto idx = it->second;
-	auto &node = m_nodes.at(idx);
+	return RemoveNode(GetHandle(*m_nodes[it->second]));
+}
+bool Graph::RemoveNode(NodeHandle handle)
+{
+	// Removing a node would change the positions of the nodes that are shared with the base graph
+	if(m_base)
+		throw std::logic_error {"Nodes cannot be removed during code generation!"};
+	auto optIdx = FindNodeIndex(handle);
+	if(!optIdx)
+		return false;
+	auto idx = *optIdx;
+	auto node = m_nodes[idx];
 	node->DisconnectAll();
-	m_nameToNodeIndex.erase(it);
-	m_nodes.erase(m_nodes.begin() + idx);
-	for(auto &[name, idxOther] : m_nameToNodeIndex) {
-		if(idxOther > idx) {
-			--idxOther;
-			m_nodes.at(idxOther)->nodeIndex = idxOther;
-		}
+	m_nameToNodeIndex.erase(node->GetName());
+	m_typeGroups.Remove(node->node.GetType(), idx);
+	m_categoryGroups.Remove(node->node.GetCategory(), idx);
+	auto &slot = m_slots[handle.slot];
+	slot.nodeIndex = NodeHandle::INVALID_SLOT;
+	++slot.generation;
+	m_freeSlots.push_back(handle.slot);
+
+	// The last node takes the place of the removed node, so no other node has to be moved
+	auto lastIdx = m_nodes.size() - 1;
+	if(idx != lastIdx) {
+		auto &moved = m_nodes[idx];
+		moved = std::move(m_nodes[lastIdx]);
+		moved->SetNodeIndex(idx);
+		m_nameToNodeIndex[moved->GetName()] = idx;
+		m_typeGroups.Move(moved->node.GetType(), lastIdx, idx);
+		m_categoryGroups.Move(moved->node.GetCategory(), lastIdx, idx);
+		m_nodeSlots[idx] = m_nodeSlots[lastIdx];
+		m_slots[m_nodeSlots[idx]].nodeIndex = idx;
 	}
+	m_nodes.pop_back();
+	m_nodeSlots.pop_back();
+	OnNodeRemoved(idx, lastIdx);
 	return true;
 }
+NodeHandle Graph::GetHandle(const GraphNode &node) const
+{
+	if(node.nodeIndex >= m_nodes.size() || m_nodes[node.nodeIndex].get() != &node)
+		return {};
+	auto slot = m_nodeSlots[node.nodeIndex];
+	return {slot, m_slots[slot].generation};
+}
+std::optional<size_t> Graph::FindNodeIndex(NodeHandle handle) const
+{
+	if(handle.slot >= m_slots.size())
+		return {};
+	auto &slot = m_slots[handle.slot];
+	if(slot.generation != handle.generation || slot.nodeIndex == NodeHandle::INVALID_SLOT)
+		return {};
+	return slot.nodeIndex;
+}
+std::shared_ptr<GraphNode> Graph::GetNode(NodeHandle handle) const
+{
+	auto idx = FindNodeIndex(handle);
+	if(!idx)
+		return nullptr;
+	return m_nodes[*idx];
+}
+void Graph::ReserveNodes(size_t count)
+{
+	m_nodes.reserve(count);
+	m_nameToNodeIndex.reserve(count);
+	m_nodeSlots.reserve(count);
+	m_slots.reserve(count);
+	m_typeGroups.positions.reserve(count);
+	m_categoryGroups.positions.reserve(count);
+}
+void Graph::AllocateSlot(uint32_t nodeIdx)
+{
+	uint32_t slot;
+	if(!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slot = m_slots.size();
+		m_slots.push_back({});
+	}
+	m_slots[slot].nodeIndex = nodeIdx;
+	m_nodeSlots.push_back(slot);
+}
 void Graph::AddNode(const std::shared_ptr<GraphNode> &node)
 {
-	std::string name {(*node)->GetType()};
-	size_t i = 1;
+	// Names are generated from a counter per node type, so the next free name is usually found with a single lookup.
+	// Further names only have to be probed if the name was taken by a loaded node.
+	auto type = (*node)->GetType();
+	auto &counter = m_nameCounters[&node->node];
+	std::string name;
+	name.reserve(type.size() + 10);
 	for(;;) {
-		auto namei = name + util::to_string(i);
-		if(m_nameToNodeIndex.find(namei) == m_nameToNodeIndex.end()) {
-			name = std::move(namei);
+		++counter;
+		name.assign(type);
+		std::array<char, 10> buf;
+		auto [end, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), counter);
+		name.append(buf.data(), end);
+		if(!IsNameInUse(name))
 			break;
-		}
-		++i;
 	}
 
 	node->SetName(name);
+	node->SetNodeIndex(m_nodes.size());
 	m_nodes.push_back(node);
 	m_nameToNodeIndex[name] = m_nodes.size() - 1;
+	AllocateSlot(m_nodes.size() - 1);
+	AddToNodeGroups(*node);
+	OnNodeAdded(m_nodes.size() - 1);
+}
+void Graph::UpdateNameCounter(const GraphNode &node)
+{
+	// Names that were generated by AddNode ("<type><number>") advance the counter of the type past them,
+	// so that new nodes don't have to probe all loaded names
+	std::string_view name {node.m_name};
+	auto type = node.node.GetType();
+	if(!name.starts_with(type))
+		return;
+	uint32_t number;
+	auto *first = name.data() + type.size();
+	auto *last = name.data() + name.size();
+	auto [end, ec] = std::from_chars(first, last, number);
+	if(ec != std::errc {} || end != last)
+		return;
+	auto &counter = m_nameCounters[&node.node];
+	counter = std::max(counter, number);
+}
+bool Graph::IsNameInUse(const std::string &name) const
+{
+	if(m_nameToNodeIndex.find(name) != m_nameToNodeIndex.end())
+		return true;
+	return m_base && m_base->m_nameToNodeIndex.find(name) != m_base->m_nameToNodeIndex.end();
 }
 std::shared_ptr<GraphNode> Graph::AddNode(const std::string &type)
 {
@@ -155,66 +523,279 @@ std::shared_ptr<GraphNode> Graph::AddNode(const std::string &type)
 	return inst;
 }
 
-std::vector<GraphNode *> Graph::TopologicalSort(const std::vector<std::shared_ptr<GraphNode>> &nodes) const
+const Graph::TopologyCache &Graph::GetTopology() const
 {
-	std::unordered_map<GraphNode *, int> in_degree;
-	std::unordered_map<GraphNode *, std::vector<GraphNode *>> adj_list;
+	std::scoped_lock lock {m_topologyMutex};
+	UpdateCompiledGraph();
+	UpdateTopologicalOrder();
+	CompactTopologicalOrder();
+	return m_topology;
+}
 
-	// Step 1: Initialize in-degree and adjacency list
-	for(const auto &node : nodes) {
-		in_degree[node.get()] = 0; // Initialize in-degree count
-	}
+void Graph::UpdateCompiledGraph() const
+{
+	auto &topology = m_topology;
+	if(topology.compiledValid)
+		return;
+	// The buffers of the previous snapshot are re-used, so no memory is allocated unless the graph has grown
+	topology.compiled.Build(*this);
+	topology.compiledValid = true;
+}
 
-	for(const auto &node : nodes) {
-		for(auto &output : node->outputs) {
-			for(auto *input_link : output.links) {
-				GraphNode *dependent_node = input_link->parent;
+void Graph::UpdateTopologicalOrder() const
+{
+	auto &topology = m_topology;
+	if(topology.orderValid)
+		return;
+	UpdateCompiledGraph();
+	topology.acyclic = topology.compiled.TopologicalSort(topology.order, topology.scratch);
+	topology.numRemoved = 0;
+	topology.positions.assign(m_nodes.size(), CompiledGraph::INVALID_INDEX);
+	for(uint32_t i = 0; i < topology.order.size(); ++i)
+		topology.positions[topology.order[i]] = i;
+	topology.orderValid = true;
+}
+
+const std::vector<uint32_t> &Graph::GetTopologicalOrder() const
+{
+	std::scoped_lock lock {m_topologyMutex};
+	UpdateTopologicalOrder();
+	CompactTopologicalOrder();
+	if(!m_topology.acyclic)
+		throw std::runtime_error("Cycle detected in shader graph; topological sort not possible");
+	return m_topology.order;
+}
+
+bool Graph::SearchTopology(const GraphNode &start, bool forward, uint32_t bound, const GraphNode *target, std::vector<uint32_t> &outNodes) const
+{
+	auto &topology = m_topology;
+	auto &marks = topology.visitMarks;
+	if(marks.size() < m_nodes.size())
+		marks.resize(m_nodes.size(), 0);
+	if(++topology.visitEpoch == 0) {
+		std::fill(marks.begin(), marks.end(), 0);
+		topology.visitEpoch = 1;
+	}
+	auto epoch = topology.visitEpoch;
+	auto &positions = topology.positions;
+	// Forward searches only visit nodes that precede the bound, backward searches only nodes that succeed it
+	auto isInBounds = [forward, bound, &positions](uint32_t nodeIdx) { return forward ? (positions[nodeIdx] <= bound) : (positions[nodeIdx] >= bound); };
 
-				// Populate adjacency list and in-degree count
-				adj_list[node.get()].push_back(dependent_node);
-				in_degree[dependent_node]++;
+	outNodes.clear();
+	auto &stack = topology.searchStack;
+	stack.clear();
+	stack.push_back(start.nodeIndex);
+	marks[start.nodeIndex] = epoch;
+	while(!stack.empty()) {
+		auto nodeIdx = stack.back();
+		stack.pop_back();
+		outNodes.push_back(nodeIdx);
+		auto visit = [&](const GraphNode &other) -> bool {
+			if(&other == target)
+				return true;
+			if(marks[other.nodeIndex] != epoch && isInBounds(other.nodeIndex)) {
+				marks[other.nodeIndex] = epoch;
+				stack.push_back(other.nodeIndex);
+			}
+			return false;
+		};
+		auto &node = *m_nodes[nodeIdx];
+		if(forward) {
+			for(auto &output : node.outputs) {
+				for(auto *link : output.links) {
+					if(visit(*link->parent))
+						return true;
+				}
+			}
+		}
+		else {
+			for(auto &input : node.inputs) {
+				if(input.link && input.link->parent && visit(*input.link->parent))
+					return true;
 			}
 		}
 	}
+	return false;
+}
 
-	// Step 2: Collect all nodes with zero in-degree
-	std::queue<GraphNode *> zero_in_degree_queue;
-	for(auto &[node, degree] : in_degree) {
-		if(degree == 0) {
-			zero_in_degree_queue.push(node);
-		}
+bool Graph::IsReachable(const GraphNode &from, const GraphNode &to) const
+{
+	if(&from.graph != this || &to.graph != this)
+		return false;
+	if(&from == &to)
+		return true;
+	std::scoped_lock lock {m_topologyMutex};
+	UpdateTopologicalOrder();
+	auto &topology = m_topology;
+	auto bound = std::numeric_limits<uint32_t>::max();
+	if(topology.acyclic) {
+		// In a topological order, a node can only reach the nodes that come after it, and the search
+		// only has to consider the nodes between the two
+		auto posFrom = topology.positions[from.nodeIndex];
+		auto posTo = topology.positions[to.nodeIndex];
+		if(posFrom > posTo)
+			return false;
+		bound = posTo;
 	}
+	return SearchTopology(from, true, bound, &to, topology.forward);
+}
 
-	// Step 3: Process the nodes in topological order
-	std::vector<GraphNode *> sorted_nodes;
-	while(!zero_in_degree_queue.empty()) {
-		GraphNode *node = zero_in_degree_queue.front();
-		zero_in_degree_queue.pop();
-		sorted_nodes.push_back(node);
+bool Graph::WouldCreateCycle(const GraphNode &producer, const GraphNode &consumer) const
+{
+	// The output links of a view are incomplete (see Graph::Materialize), and its links are only changed by node expansions
+	// and the optimization passes, which never introduce cycles
+	if(m_base)
+		return false;
+	return IsReachable(consumer, producer);
+}
 
-		// Decrease in-degree for all neighbors
-		for(auto *neighbor : adj_list[node]) {
-			in_degree[neighbor]--;
-			if(in_degree[neighbor] == 0) {
-				zero_in_degree_queue.push(neighbor);
-			}
+void Graph::OnNodeAdded(uint32_t nodeIdx)
+{
+	auto &topology = m_topology;
+	topology.compiledValid = false;
+	if(!topology.orderValid)
+		return;
+	// A node without links can be placed anywhere
+	topology.positions.resize(m_nodes.size(), CompiledGraph::INVALID_INDEX);
+	topology.positions[nodeIdx] = topology.order.size();
+	topology.order.push_back(nodeIdx);
+}
+
+void Graph::OnNodeRemoved(uint32_t nodeIdx, uint32_t movedNodeIdx)
+{
+	auto &topology = m_topology;
+	topology.compiledValid = false;
+	if(!topology.orderValid || !topology.acyclic) {
+		topology.orderValid = false;
+		return;
+	}
+	// The node had no links anymore, so removing it keeps the order intact. Its entry is only marked, so that
+	// removing many nodes doesn't shift the order every time (see CompactTopologicalOrder).
+	auto &order = topology.order;
+	auto &positions = topology.positions;
+	order[positions[nodeIdx]] = CompiledGraph::INVALID_INDEX;
+	++topology.numRemoved;
+	if(movedNodeIdx != nodeIdx) {
+		positions[nodeIdx] = positions[movedNodeIdx];
+		order[positions[nodeIdx]] = nodeIdx;
+	}
+	positions.pop_back();
+}
+
+void Graph::CompactTopologicalOrder() const
+{
+	auto &topology = m_topology;
+	if(topology.numRemoved == 0)
+		return;
+	auto &order = topology.order;
+	order.erase(std::remove(order.begin(), order.end(), CompiledGraph::INVALID_INDEX), order.end());
+	for(uint32_t i = 0; i < order.size(); ++i)
+		topology.positions[order[i]] = i;
+	topology.numRemoved = 0;
+}
+
+void Graph::OnLinked(const GraphNode &producer, const GraphNode &consumer)
+{
+	auto &topology = m_topology;
+	topology.compiledValid = false;
+	if(!topology.orderValid)
+		return;
+	if(m_base || !topology.acyclic || &producer.graph != this) {
+		topology.orderValid = false;
+		return;
+	}
+	auto &positions = topology.positions;
+	auto lowerBound = positions[consumer.nodeIndex];
+	auto upperBound = positions[producer.nodeIndex];
+	if(upperBound < lowerBound)
+		return;
+	// Pearce-Kelly: Only the nodes between the consumer and the producer in the order can be affected. The nodes that depend on the consumer
+	// and the nodes the producer depends on are moved, so that the latter come first, using the positions that were occupied by both sets.
+	// The link was checked by CanLink, so the consumer cannot reach the producer.
+	auto &forward = topology.forward;
+	auto &backward = topology.backward;
+	SearchTopology(consumer, true, upperBound, nullptr, forward);
+	SearchTopology(producer, false, lowerBound, nullptr, backward);
+	auto byPosition = [&positions](uint32_t a, uint32_t b) { return positions[a] < positions[b]; };
+	std::sort(forward.begin(), forward.end(), byPosition);
+	std::sort(backward.begin(), backward.end(), byPosition);
+
+	auto &slots = topology.scratch;
+	slots.clear();
+	for(auto nodeIdx : backward)
+		slots.push_back(positions[nodeIdx]);
+	for(auto nodeIdx : forward)
+		slots.push_back(positions[nodeIdx]);
+	std::sort(slots.begin(), slots.end());
+	size_t slot = 0;
+	auto place = [&topology, &slots, &slot](uint32_t nodeIdx) {
+		auto pos = slots[slot++];
+		topology.order[pos] = nodeIdx;
+		topology.positions[nodeIdx] = pos;
+	};
+	for(auto nodeIdx : backward)
+		place(nodeIdx);
+	for(auto nodeIdx : forward)
+		place(nodeIdx);
+}
+
+hash::Hash Graph::GetStructuralHash() const
+{
+	std::vector<hash::Hash> sinkHashes;
+	for(auto &node : m_nodes) {
+		if(node->node.IsOutputNode())
+			sinkHashes.push_back(node->GetStructuralHash());
+	}
+	if(sinkHashes.empty()) {
+		for(auto &node : m_nodes) {
+			if(std::all_of(node->outputs.begin(), node->outputs.end(), [](const OutputSocket &output) { return output.links.empty(); }))
+				sinkHashes.push_back(node->GetStructuralHash());
 		}
 	}
+	// Sorted so that the hash doesn't depend on the order of the nodes
+	std::sort(sinkHashes.begin(), sinkHashes.end());
+	auto h = hash::hash_value(sinkHashes.size());
+	for(auto sinkHash : sinkHashes)
+		h = hash::hash_combine(h, sinkHash);
+	return h;
+}
 
-	// Step 4: Check for cycles
-	if(sorted_nodes.size() != nodes.size()) {
-		throw std::runtime_error("Cycle detected in shader graph; topological sort not possible");
+// The generated code of a node only depends on its own index (which determines its variable names),
+// the variable names of the linked outputs and the values of the unlinked inputs.
+static hash::Hash get_glsl_code_signature(const GraphNode &node)
+{
+	auto h = hash::hash_value(node.nodeIndex);
+	for(auto &input : node.inputs) {
+		if(input.link && input.link->parent) {
+			h = hash::hash_combine(h, 'L');
+			h = hash::hash_combine(h, input.link->parent->nodeIndex);
+			h = hash::hash_combine(h, input.link->outputIndex);
+			continue;
+		}
+		h = hash::hash_combine(h, 'C');
+		h = hash::hash_combine(h, input.GetValueHash());
 	}
+	return h;
+}
 
-	return sorted_nodes;
+hash::Hash Graph::GetLayoutHash() const
+{
+	auto h = hash::hash_value(m_nodes.size());
+	for(auto &node : m_nodes) {
+		h = hash::hash_string(node->GetName(), h);
+		h = hash::hash_string(node->node.GetType(), h);
+		h = hash::hash_combine(h, get_glsl_code_signature(*node));
+	}
+	return h;
 }
 
 void Graph::DebugPrint()
 {
-	auto sortedNodes = TopologicalSort(m_nodes);
+	auto &order = GetTopologicalOrder();
 	// Print the topologically sorted nodes in order
 	std::cout << "Topological Sort Order:\n";
-	for(const auto *node : sortedNodes) {
+	for(auto nodeIdx : order) {
+		auto *node = m_nodes[nodeIdx].get();
 		std::cout << "Node " << node->GetName() << " (" << node->node.GetType() << ")" << "\n";
 
 		// Print Inputs
@@ -271,10 +852,11 @@ void Graph::FindInvalidLinks()
 
 //void ConnectNodes(Node::Ptr outputNode, int outputIndex, Node::Ptr inputNode, int inputIndex) { connections.emplace_back(outputNode, outputIndex, inputNode, inputIndex); }
 
-bool Graph::Load(const std::string &filePath, std::string &outErr)
+bool Graph::Load(const std::string &filePath, std::string &outErr, uint32_t threadCount)
 {
 	std::shared_ptr<udm::Data> data {};
 	try {
+		// The format (binary or text) is determined from the file header, not the extension
 		data = udm::Data::Load(filePath);
 	}
 	catch(const udm::Exception &e) {
@@ -288,13 +870,59 @@ bool Graph::Load(const std::string &filePath, std::string &outErr)
 	auto assetData = data->GetAssetData();
 
 	auto udmData = assetData.GetData();
-	auto result = Load(udmData, outErr);
+	auto result = Load(udmData, outErr, threadCount);
 	if(!result)
 		return false;
 	return true;
 }
 
-bool Graph::Load(udm::LinkedPropertyWrapper &prop, std::string &outErr)
+std::shared_ptr<GraphNode> Graph::LoadNode(udm::LinkedPropertyWrapper &udmNode, uint32_t nodeIdx, GraphNode::LoadedLinks &outLinks, std::string &outErr)
+{
+	// Must not modify the graph, since nodes may be loaded concurrently (see Load)
+	std::string type;
+	udmNode["type"] >> type;
+
+	auto node = m_nodeRegistry->GetNode(type);
+	if(!node) {
+		outErr = "Unknown node type '" + type + "'!";
+		return nullptr;
+	}
+
+	std::string name;
+	udmNode["name"] >> name;
+	auto inst = std::make_shared<GraphNode>(*this, *node);
+	inst->SetName(name);
+	inst->SetNodeIndex(nodeIdx);
+	if(!inst->LoadFromAssetData(udmNode, outLinks, outErr))
+		return nullptr;
+	return inst;
+}
+
+bool Graph::InsertLoadedNode(const std::shared_ptr<GraphNode> &node, std::string &outErr)
+{
+	auto &name = node->m_name;
+	if(m_nameToNodeIndex.find(name) != m_nameToNodeIndex.end()) {
+		outErr = "Multiple nodes with name '" + name + "'. This is not allowed!";
+		return false;
+	}
+	m_nodes.push_back(node);
+	m_nameToNodeIndex[name] = m_nodes.size() - 1;
+	AllocateSlot(m_nodes.size() - 1);
+	AddToNodeGroups(*node);
+	UpdateNameCounter(*node);
+	return true;
+}
+
+void Graph::RemoveLoadedNodes(size_t firstNodeIdx)
+{
+	// The loaded nodes were never added to the cached topological order (see OnNodeAdded), so it has to be discarded before
+	// the nodes are removed. They are removed from the back, so no other node has to be moved (see RemoveNode).
+	InvalidateTopology();
+	while(m_nodes.size() > firstNodeIdx)
+		RemoveNode(GetHandle(*m_nodes.back()));
+}
+
+bool Graph::Load(udm::LinkedPropertyWrapper &prop, std::string &outErr, uint32_t threadCount)
 {
 	/*if(data.GetAssetType() != PSG_IDENTIFIER) {
 		outErr = "Incorrect format!";
@@ -310,46 +938,131 @@ bool Graph::Load(udm::LinkedPropertyWrapper &prop, std::string &outErr)
 
 	auto udmNodes = prop["nodes"];
 	auto numNodes = udmNodes.GetSize();
-	std::vector<GraphNode::SocketLink> links;
-	for(size_t idx = 0; idx < numNodes; ++idx) {
-		auto udmNode = udmNodes[idx];
-		std::string type;
-		udmNode["type"] >> type;
-
-		auto node = m_nodeRegistry->GetNode(type);
-		if(!node) {
-			outErr = "Unknown node type '" + type + "'!";
-			return false;
-		}
+	auto firstNodeIdx = m_nodes.size();
+	ReserveNodes(firstNodeIdx + numNodes);
 
-		std::string name;
-		udmNode["name"] >> name;
-		auto inst = std::make_shared<GraphNode>(*this, *node);
-		inst->SetName(name);
-		if(!inst->LoadFromAssetData(udmNode, links, outErr))
-			return false;
-		if(m_nameToNodeIndex.find(name) != m_nameToNodeIndex.end()) {
-			outErr = "Multiple nodes with name '" + name + "'. This is not allowed!";
+	// Pass 1: Create all nodes and collect their links. The nodes are independent of each other until they are linked, so they can be
+	// created in parallel. Each thread loads a contiguous range of nodes and stops at its first error, so the error of the first failing
+	// node is reported, regardless of the number of threads.
+	// The inputs are counted beforehand, which is an upper bound for the number of links, so the links can be allocated up-front.
+	if(threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	// Loading a node is cheap, so small graphs aren't worth the overhead of the threads
+	constexpr size_t MIN_NODES_PER_THREAD = 256;
+	auto numChunks = std::clamp<size_t>(numNodes / MIN_NODES_PER_THREAD, 1, threadCount);
+	struct Chunk {
+		size_t begin = 0;
+		size_t end = 0;
+		GraphNode::LoadedLinks links;
+		std::optional<size_t> failedNodeIdx {};
+		std::string err;
+	};
+	std::vector<Chunk> chunks(numChunks);
+	std::vector<std::shared_ptr<GraphNode>> nodes(numNodes);
+	auto loadChunk = [this, &udmNodes, &nodes, firstNodeIdx](Chunk &chunk) {
+		size_t numInputs = 0;
+		for(auto idx = chunk.begin; idx < chunk.end; ++idx)
+			numInputs += udmNodes[idx]["inputs"].GetSize();
+		chunk.links.links.reserve(numInputs);
+		for(auto idx = chunk.begin; idx < chunk.end; ++idx) {
+			auto udmNode = udmNodes[idx];
+			nodes[idx] = LoadNode(udmNode, firstNodeIdx + idx, chunk.links, chunk.err);
+			if(!nodes[idx]) {
+				chunk.failedNodeIdx = idx;
+				break;
+			}
+		}
+	};
+	for(size_t i = 0; i < numChunks; ++i) {
+		chunks[i].begin = numNodes * i / numChunks;
+		chunks[i].end = numNodes * (i + 1) / numChunks;
+	}
+	if(numChunks == 1)
+		loadChunk(chunks.front());
+	else {
+		// The UDM data is only read, which is safe to do from multiple threads
+		std::vector<std::thread> threads;
+		threads.reserve(numChunks - 1);
+		for(size_t i = 1; i < numChunks; ++i)
+			threads.emplace_back(loadChunk, std::ref(chunks[i]));
+		loadChunk(chunks.front());
+		for(auto &thread : threads)
+			thread.join();
+	}
+	for(auto &chunk : chunks) {
+		if(chunk.failedNodeIdx) {
+			outErr = "Failed to load node " + util::to_string(*chunk.failedNodeIdx) + ": " + chunk.err;
 			return false;
 		}
-		m_nodes.push_back(inst);
-		m_nameToNodeIndex[name] = m_nodes.size() - 1;
 	}
 
-	for(auto &link : links) {
-		auto node = GetNode(link.outputNode);
-		if(!node)
-			return false;
-		auto *output = node->FindOutput(link.outputName);
-		if(!output)
-			return false;
-		if(!node->Link(link.outputName, *link.inputSocket->parent, link.inputSocket->GetSocket().name))
-			return false;
+	// Everything from here on modifies the graph, so it has to be undone if an error occurs
+	auto prevNameCounters = m_nameCounters;
+	auto fail = [this, firstNodeIdx, &prevNameCounters, &outErr](std::string err) {
+		RemoveLoadedNodes(firstNodeIdx);
+		m_nameCounters = std::move(prevNameCounters);
+		outErr = std::move(err);
+		return false;
+	};
+
+	// The names are registered in node order, so duplicates are reported deterministically as well
+	std::string err;
+	for(auto &node : nodes) {
+		if(!InsertLoadedNode(node, err))
+			return fail(std::move(err));
 	}
 
+	// Pass 2: Connect the links directly. The chunks are processed in node order, and the name tables of a chunk are only resolved
+	// once per distinct node name, and once per distinct output name and node type. Cycles are detected by a single topological sort
+	// afterwards, instead of validating every link individually (see GraphNode::Link).
+	constexpr auto UNRESOLVED = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> producerIndices;
+	std::unordered_map<const Node *, std::vector<uint32_t>> outputIndices;
+	for(auto &chunk : chunks) {
+		auto &loadedLinks = chunk.links;
+		producerIndices.assign(loadedLinks.nodeNames.strings.size(), UNRESOLVED);
+		outputIndices.clear();
+		for(auto &link : loadedLinks.links) {
+			auto &nodeName = loadedLinks.nodeNames.strings[link.outputNode];
+			auto &outputName = loadedLinks.outputNames.strings[link.outputName];
+			auto &producerIdx = producerIndices[link.outputNode];
+			if(producerIdx == UNRESOLVED) {
+				auto it = m_nameToNodeIndex.find(nodeName);
+				if(it == m_nameToNodeIndex.end())
+					return fail("Link to unknown node '" + nodeName + "'!");
+				producerIdx = it->second;
+			}
+			auto &producer = *m_nodes[producerIdx];
+			auto &typeOutputIndices = outputIndices[&producer.node];
+			if(typeOutputIndices.empty())
+				typeOutputIndices.assign(loadedLinks.outputNames.strings.size(), UNRESOLVED);
+			auto &outputIdx = typeOutputIndices[link.outputName];
+			if(outputIdx == UNRESOLVED) {
+				auto idx = producer.node.FindOutputIndex(outputName);
+				if(!idx)
+					return fail("Node '" + nodeName + "' has no output named '" + outputName + "'!");
+				outputIdx = *idx;
+			}
+			auto &output = producer.outputs[outputIdx];
+			auto &input = *link.inputSocket;
+			if(&producer == input.parent || !input.GetSocket().IsLinkable() || !is_data_type_compatible(output.GetSocket().type, input.GetSocket().type))
+				return fail("Output '" + outputName + "' of node '" + nodeName + "' cannot be linked to input '" + input.GetSocket().name + "' of node '" + input.parent->GetName() + "'!");
+			output.links.push_back(&input);
+			input.link = &output;
+		}
+	}
+	InvalidateTopology();
+	if(!GetTopology().acyclic)
+		return fail("Shader graph contains a cycle!");
 	return true;
 }
 
+static bool is_binary_file_path(const std::string &filePath)
+{
+	auto ext = std::filesystem::path {filePath}.extension().string();
+	return !ext.empty() && std::string_view {ext}.substr(1) == Graph::EXTENSION_BINARY;
+}
+
 bool Graph::Save(const std::string &filePath, std::string &outErr) const
 {
 	auto data = udm::Data::Create();
@@ -358,7 +1071,11 @@ bool Graph::Save(const std::string &filePath, std::string &outErr) const
 	if(!result)
 		return false;
 	try {
-		result = data->SaveAscii(filePath);
+		// The format is determined by the extension, everything but EXTENSION_BINARY is saved as text
+		if(is_binary_file_path(filePath))
+			result = data->Save(filePath);
+		else
+			result = data->SaveAscii(filePath);
 	}
 	catch(const udm::Exception &e) {
 		outErr = e.what();
@@ -392,19 +1109,230 @@ void Graph::Resolve()
 	// We can't use an iterator here because we need to expand nodes, which may add new nodes during iteration
 	size_t i = 0;
 	while(i < m_nodes.size()) {
-		auto &node = m_nodes[i];
-		node->node.Expand(*this, *node);
+		auto *node = m_nodes[i].get();
+		if(node->node.HasExpansion()) {
+			// Expand may modify the node and its neighbors
+			auto &materialized = MaterializeNeighborhood(*node);
+			materialized.node.Expand(*this, materialized);
+		}
 		++i;
 	}
+}
+
+// Whether the generated code of the node depends on nothing but its inputs.
+// Shader and output nodes are consumed by the engine directly, and input and texture nodes may be bound to external data,
+// so they always have to be emitted as they are.
+static bool is_pure_node(const Node &nodeType)
+{
+	if(nodeType.IsOutputNode())
+		return false;
+	auto &category = nodeType.GetCategory();
+	return category != CATEGORY_SHADER && category != CATEGORY_OUTPUT && category != CATEGORY_INPUT_PARAMETER && category != CATEGORY_INPUT_SYSTEM && category != CATEGORY_TEXTURE;
+}
 
-	for(size_t i = 0; i < m_nodes.size(); ++i)
-		m_nodes[i]->nodeIndex = i;
+static bool is_constant_foldable(const GraphNode &node)
+{
+	auto &nodeType = node.node;
+	if(!nodeType.HasKernel() || node.outputs.empty() || !is_pure_node(nodeType))
+		return false;
+	for(auto &input : node.inputs) {
+		if((input.link && input.link->parent) || get_register_count(input.GetSocket().type) == 0)
+			return false;
+	}
+	for(auto &output : node.outputs) {
+		if(get_register_count(output.GetSocket().type) == 0)
+			return false;
+	}
+	return true;
+}
+
+void Graph::FoldConstants(std::vector<GraphNode *> &sortedNodes)
+{
+	std::vector<float> registers;
+	std::vector<Register> operands;
+	std::unordered_set<const GraphNode *> foldedNodes;
+	// Nodes are visited in topological order, so consumers of a folded node may become foldable themselves
+	for(auto *&node : sortedNodes) {
+		node = &ResolveNode(*node);
+		if(!is_constant_foldable(*node))
+			continue;
+		registers.clear();
+		operands.clear();
+		auto allocateRegisters = [&registers](uint32_t count) -> Register {
+			auto reg = registers.size();
+			registers.resize(reg + count, 0.f);
+			return reg;
+		};
+		for(auto &input : node->inputs) {
+			auto reg = allocateRegisters(get_register_count(input.GetSocket().type));
+			visit(input.GetSocket().type, [&input, &registers, reg](auto tag) {
+				using T = typename decltype(tag)::type;
+				if constexpr(!std::is_same_v<T, udm::String> && !std::is_same_v<T, udm::Mat4>) {
+					T val;
+					if(input.GetValue(val))
+						store_registers(registers.data() + reg, val);
+				}
+			});
+			operands.push_back(reg);
+		}
+		auto firstOutput = operands.size();
+		for(auto &output : node->outputs)
+			operands.push_back(allocateRegisters(get_register_count(output.GetSocket().type)));
+
+		try {
+			node->node.EvaluateKernel(KernelArgs {node->node.GetKernelVariant(*node), registers.data(), operands.data(), operands.data() + firstOutput});
+		}
+		catch(const std::exception &) {
+			continue;
+		}
+		// Results that can't be expressed as GLSL literals
+		if(std::any_of(registers.begin() + operands[firstOutput], registers.end(), [](float v) { return !std::isfinite(v); }))
+			continue;
+
+		auto allOutputsFolded = true;
+		for(uint32_t outputIdx = 0; outputIdx < node->outputs.size(); ++outputIdx) {
+			if(node->outputs[outputIdx].links.empty()) {
+				// The output may still be referenced by name, so the node has to be emitted
+				allOutputsFolded = false;
+				continue;
+			}
+			// Both ends of a link have to be materialized before it can be removed (see Graph::Materialize)
+			node = &Materialize(*node);
+			auto &output = node->outputs[outputIdx];
+			auto *outputRegisters = registers.data() + operands[firstOutput + outputIdx];
+			visit(output.GetSocket().type, [this, &output, outputRegisters, &allOutputsFolded](auto tag) {
+				using T = typename decltype(tag)::type;
+				if constexpr(!std::is_same_v<T, udm::String> && !std::is_same_v<T, udm::Mat4>) {
+					auto value = load_registers<T>(outputRegisters);
+					// Disconnecting modifies the link list, so we need a copy
+					auto links = output.links;
+					for(auto *link : links) {
+						auto &consumer = Materialize(*link->parent);
+						auto &input = consumer.inputs[link->inputIndex];
+						if(!input.SetValue(value)) {
+							allOutputsFolded = false;
+							continue;
+						}
+						consumer.Disconnect(input.inputIndex);
+					}
+				}
+			});
+		}
+		if(allOutputsFolded)
+			foldedNodes.insert(node);
+	}
+	if(foldedNodes.empty())
+		return;
+	sortedNodes.erase(std::remove_if(sortedNodes.begin(), sortedNodes.end(), [&foldedNodes](const GraphNode *node) { return foldedNodes.find(node) != foldedNodes.end(); }), sortedNodes.end());
+}
+
+void Graph::EliminateCommonSubexpressions(std::vector<GraphNode *> &sortedNodes)
+{
+	// Two nodes are equivalent if they have the same type and their inputs are linked to the same outputs
+	// or have the same constant value. Constants are compared by their GLSL representation, which is what ends up in the code.
+	auto makeKey = [](const GraphNode &node, std::string &outKey) -> bool {
+		outKey.clear();
+		auto appendBytes = [&outKey](const auto &v) { outKey.append(reinterpret_cast<const char *>(&v), sizeof(v)); };
+		appendBytes(&node.node);
+		for(auto &input : node.inputs) {
+			if(input.link && input.link->parent) {
+				// The node index is the same for a node and its materialized copy
+				outKey += 'L';
+				appendBytes(input.link->parent->nodeIndex);
+				appendBytes(input.link->outputIndex);
+				continue;
+			}
+			if(input.GetSocket().type == DataType::String || input.GetSocket().type == DataType::Transform)
+				return false;
+			outKey += 'C';
+			outKey += node.GetConstantValue(input.inputIndex);
+			outKey += '\0';
+		}
+		return true;
+	};
+
+	std::unordered_map<std::string, GraphNode *> uniqueNodes;
+	uniqueNodes.reserve(sortedNodes.size());
+	std::unordered_set<const GraphNode *> duplicates;
+	std::string key;
+	// In topological order the producers of a node have already been merged, so chains of duplicates collapse as well
+	for(auto *&node : sortedNodes) {
+		node = &ResolveNode(*node);
+		if(!is_pure_node(node->node) || !makeKey(*node, key))
+			continue;
+		auto it = uniqueNodes.find(key);
+		if(it == uniqueNodes.end()) {
+			uniqueNodes.emplace(key, node);
+			continue;
+		}
+		// All nodes whose links are changed have to be materialized first (see Graph::Materialize)
+		auto &original = Materialize(*it->second);
+		node = &Materialize(*node);
+		for(auto &output : node->outputs) {
+			for(size_t i = 0; i < output.links.size(); ++i)
+				Materialize(*output.links[i]->parent);
+		}
+		// Only the consumed outputs have to be moved. Pure nodes are internal to the generated code, so the variables of their
+		// unconsumed outputs have no users and can be dropped along with the duplicate (e.g. a SeparateXyz node of which only x is used).
+		for(uint32_t i = 0; i < node->outputs.size(); ++i) {
+			if(!node->outputs[i].links.empty())
+				node->Relink(i, original, i);
+		}
+		// The inputs of the duplicate are left linked, since it won't be emitted anyway
+		duplicates.insert(node);
+	}
+	if(duplicates.empty())
+		return;
+	// Nodes that were visited before may have been materialized since
+	for(auto *&node : sortedNodes)
+		node = &ResolveNode(*node);
+	sortedNodes.erase(std::remove_if(sortedNodes.begin(), sortedNodes.end(), [&duplicates](const GraphNode *node) { return duplicates.find(node) != duplicates.end(); }), sortedNodes.end());
+}
+
+const GraphNode::GlslCode &Graph::EvaluateGlsl(GraphNode &node)
+{
+	auto *origin = node.m_origin;
+	// Nodes of the base graph that were never materialized hold their own cache
+	if(!origin && &node.graph != this)
+		origin = &node;
+	auto &glslCode = origin ? origin->m_glslCode : node.m_glslCode;
+	auto signature = get_glsl_code_signature(node);
+	// The signature is required in addition to the dirty flag, because the passes before code generation
+	// (e.g. constant folding) may change the inputs of the materialized node even if the origin node hasn't changed.
+	if(origin && !origin->m_dirty && glslCode.valid && glslCode.signature == signature)
+		return glslCode;
+	// The code is generated into a scratch writer, which is re-used for all nodes. Assigning it to the cached strings
+	// re-uses their capacity, so re-generating the code of a node usually doesn't allocate.
+	thread_local CodeWriter writer;
+	writer.Clear();
+	node.node.EvaluateResourceDeclarations(*this, node, writer);
+	glslCode.resourceDeclarations.assign(writer.GetView());
+	writer.Clear();
+	node.node.Evaluate(*this, node, writer);
+	glslCode.code.assign(writer.GetView());
+	glslCode.signature = signature;
+	glslCode.valid = true;
+	if(origin)
+		origin->m_dirty = false;
+	return glslCode;
 }
 
 void Graph::DoGenerateGlsl(std::ostream &outHeader, std::ostream &outBody, const std::optional<std::string> &namePrefix)
 {
 	Resolve();
-	auto sortedNodes = TopologicalSort(m_nodes);
+	// Nodes that don't contribute to any output node are skipped entirely, including their module dependencies
+	// The order of all nodes is also a valid order for any subset of them
+	auto &order = GetTopologicalOrder();
+	auto &compiled = GetCompiledGraph();
+	auto liveNodes = compiled.FindLiveNodes();
+	std::vector<GraphNode *> sortedNodes;
+	sortedNodes.reserve(order.size());
+	for(auto nodeIdx : order) {
+		if(liveNodes[nodeIdx])
+			sortedNodes.push_back(&compiled.GetNode(nodeIdx));
+	}
+	FoldConstants(sortedNodes);
+	EliminateCommonSubexpressions(sortedNodes);
 	std::unordered_set<std::string> requiredModules;
 	for(const auto &node : sortedNodes) {
 		for(const auto &dep : node->node.GetModuleDependencies())
@@ -416,24 +1344,125 @@ void Graph::DoGenerateGlsl(std::ostream &outHeader, std::ostream &outBody, const
 		outHeader << "#include \"/modules/" << dep << ".glsl\"\n";
 	}
 
-	for(const auto &node : sortedNodes) {
-		outHeader << "// " << node->GetName() << " (" << (*node)->GetType() << ")\n";
-		outHeader << node->node.EvaluateResourceDeclarations(*this, *node);
-		outHeader << "\n";
+	// Traverse nodes and generate GLSL code for each
+	std::vector<const GraphNode::GlslCode *> nodeCode;
+	nodeCode.reserve(sortedNodes.size());
+	for(auto *node : sortedNodes)
+		nodeCode.push_back(&EvaluateGlsl(*node));
+
+	// Both sections are assembled in a writer first, so each stream is only written to once
+	thread_local CodeWriter writer;
+	auto writeSection = [&sortedNodes, &nodeCode](std::ostream &out, std::string GraphNode::GlslCode::*member) {
+		writer.Clear();
+		for(size_t i = 0; i < sortedNodes.size(); ++i) {
+			auto *node = sortedNodes[i];
+			writer << "// " << node->GetName() << " (" << (*node)->GetType() << ")\n";
+			writer << nodeCode[i]->*member;
+			writer << "\n";
+		}
+		auto code = writer.GetView();
+		out.write(code.data(), code.size());
+	};
+	writeSection(outHeader, &GraphNode::GlslCode::resourceDeclarations);
+	writeSection(outBody, &GraphNode::GlslCode::code);
+}
+
+bool Graph::DoCompileBytecode(BytecodeProgram &outProgram, std::string &outErr)
+{
+	Resolve();
+	auto &topology = GetTopology();
+	if(!topology.acyclic) {
+		outErr = "Cycle detected in shader graph; topological sort not possible";
+		return false;
 	}
+	auto &compiled = topology.compiled;
+	auto &order = topology.order;
 
-	// Traverse nodes and generate GLSL code for each
-	for(const auto &node : sortedNodes) {
-		outBody << "// " << node->GetName() << " (" << (*node)->GetType() << ")\n";
-		outBody << node->node.Evaluate(*this, *node);
-		outBody << "\n";
+	auto &program = outProgram;
+	program.Clear();
+	program.m_instructions.reserve(order.size());
+	auto allocateRegisters = [&program](uint32_t count) -> Register {
+		auto reg = program.m_initialRegisters.size();
+		program.m_initialRegisters.resize(reg + count, 0.f);
+		return reg;
+	};
+	auto getRegisterCount = [&outErr](const GraphNode &node, const Socket &socket) -> uint32_t {
+		auto n = get_register_count(socket.type);
+		if(n == 0)
+			outErr = "Socket '" + socket.name + "' of node '" + node.GetName() + "' has type '" + std::string {magic_enum::enum_name(socket.type)} + "', which cannot be evaluated on the CPU!";
+		return n;
+	};
+
+	// Operand index of the first output register of each node, by node index
+	std::vector<uint32_t> outputOperands(m_nodes.size(), 0);
+	for(auto nodeIdx : order) {
+		auto *node = &compiled.GetNode(nodeIdx);
+		auto &nodeType = node->node;
+		if(!nodeType.HasKernel()) {
+			outErr = "Node '" + node->GetName() + "' of type '" + std::string {nodeType.GetType()} + "' has no CPU kernel!";
+			return false;
+		}
+		BytecodeInstruction instr {};
+		instr.node = &nodeType;
+		instr.variant = nodeType.GetKernelVariant(*node);
+		instr.firstOperand = program.m_operands.size();
+		instr.numInputs = node->inputs.size();
+
+		for(auto &input : node->inputs) {
+			auto &socket = input.GetSocket();
+			auto numRegisters = getRegisterCount(*node, socket);
+			if(numRegisters == 0)
+				return false;
+			if(input.link && input.link->parent) {
+				auto *output = input.link;
+				if(get_register_count(output->GetSocket().type) != numRegisters) {
+					outErr = "Output '" + output->GetSocket().name + "' of node '" + output->parent->GetName() + "' cannot be converted to input '" + socket.name + "' of node '" + node->GetName() + "' on the CPU!";
+					return false;
+				}
+				program.m_operands.push_back(program.m_operands[outputOperands[output->parent->nodeIndex] + output->outputIndex]);
+				continue;
+			}
+			auto reg = allocateRegisters(numRegisters);
+			visit(socket.type, [&input, &program, reg](auto tag) {
+				using T = typename decltype(tag)::type;
+				if constexpr(!std::is_same_v<T, udm::String> && !std::is_same_v<T, udm::Mat4>) {
+					T val;
+					if(input.GetValue(val))
+						store_registers(program.m_initialRegisters.data() + reg, val);
+				}
+			});
+			program.m_operands.push_back(reg);
+			program.m_inputs.push_back({node->GetName(), socket.name, socket.type, reg});
+		}
+
+		outputOperands[node->nodeIndex] = program.m_operands.size();
+		for(auto &output : node->outputs) {
+			auto &socket = output.GetSocket();
+			auto numRegisters = getRegisterCount(*node, socket);
+			if(numRegisters == 0)
+				return false;
+			auto reg = allocateRegisters(numRegisters);
+			program.m_operands.push_back(reg);
+			program.m_outputs.push_back({node->GetName(), socket.name, socket.type, reg});
+		}
+		program.m_instructions.push_back(instr);
 	}
+	return true;
+}
+
+bool Graph::CompileBytecode(BytecodeProgram &outProgram, std::string &outErr) const
+{
+	// Same as with GenerateGlsl, the graph has to be resolved first, so we operate on a view
+	Graph view {ViewTag {}, *this};
+	return view.DoCompileBytecode(outProgram, outErr);
 }
 
 void Graph::GenerateGlsl(std::ostream &outHeader, std::ostream &outBody, const std::optional<std::string> &namePrefix) const
 {
-	// To generate the GLSL code we need to expand all nodes (such as group nodes),
-	// which modifies the graph. We create a copy so we don't have to modify the original graph.
-	auto cpy = *this;
-	cpy.DoGenerateGlsl(outHeader, outBody, namePrefix);
+	// To generate the GLSL code we need to expand all nodes (such as group nodes) and run the optimization passes,
+	// which modifies the graph. We operate on a view, which only copies the nodes that are actually modified.
+	// The view stores the generated code in the nodes of this graph (see EvaluateGlsl), so it has to be locked.
+	std::scoped_lock lock {m_glslCodeMutex};
+	Graph view {ViewTag {}, *this};
+	view.DoGenerateGlsl(outHeader, outBody, namePrefix);
 }
@@ -8,6 +8,7 @@ module;
 module pragma.shadergraph;
 
 import :graph_node;
+import :graph;
 
 using namespace pragma::shadergraph;
 
@@ -15,12 +16,17 @@ OutputSocket::OutputSocket(GraphNode &node, uint32_t index) : parent {&node}, ou
 const Socket &OutputSocket::GetSocket() const { return *parent->node.GetOutput(outputIndex); }
 
 InputSocket::InputSocket(GraphNode &node, uint32_t index) : parent {&node}, inputIndex {index}, value {GetSocket().type} {}
-InputSocket::~InputSocket() { ClearValue(); }
-void InputSocket::ClearValue() { value.Clear(); }
+InputSocket::~InputSocket() { value.Clear(); }
+void InputSocket::ClearValue()
+{
+	value.Clear();
+	parent->MarkDirty();
+}
 bool InputSocket::HasValue() const { return value; }
 const Socket &InputSocket::GetSocket() const { return *parent->node.GetInput(inputIndex); }
+hash::Hash InputSocket::GetValueHash() const { return value ? value.GetHash() : GetSocket().defaultValue.GetHash(); }
 
-GraphNode::GraphNode(Graph &graph, const GraphNode &other) : graph {graph}, node {other.node}, m_name {other.m_name}, m_displayName {other.m_displayName}, nodeIndex {other.nodeIndex}, inputs {other.inputs}, outputs {other.outputs}, m_pos {other.m_pos} {}
+GraphNode::GraphNode(Graph &graph, const GraphNode &other) : graph {graph}, node {other.node}, m_name {other.m_name}, m_displayName {other.m_displayName}, nodeIndex {other.nodeIndex}, inputs {other.inputs}, outputs {other.outputs}, m_pos {other.m_pos}, m_varNames {other.m_varNames}, m_varNameOffsets {other.m_varNameOffsets} {}
 GraphNode::GraphNode(Graph &graph, Node &node) : graph {graph}, node {node}
 {
 	auto &nodeInputs = node.GetInputs();
@@ -32,6 +38,7 @@ GraphNode::GraphNode(Graph &graph, Node &node) : graph {graph}, node {node}
 	outputs.reserve(nodeOutputs.size());
 	for(uint32_t i = 0; i < nodeOutputs.size(); ++i)
 		outputs.emplace_back(*this, i);
+	SetNodeIndex(nodeIndex);
 }
 std::string GraphNode::GetName() const { return m_name; }
 void GraphNode::ClearInputValue(const std::string_view &inputName)
@@ -144,6 +151,8 @@ bool GraphNode::Disconnect(uint32_t inputIdx)
 	assert(it != input.link->links.end());
 	input.link->links.erase(it);
 	input.link = nullptr;
+	MarkDirty();
+	graph.OnUnlinked();
 	return true;
 }
 bool GraphNode::Disconnect(const std::string_view &inputName)
@@ -186,6 +195,9 @@ bool GraphNode::CanLink(uint32_t outputIdx, GraphNode &linkTarget, uint32_t inpu
 		return false;
 	if(!is_data_type_compatible(output->GetSocket().type, input->GetSocket().type))
 		return false;
+	// The link would create a cycle if this node already depends on the target
+	if(&linkTarget.graph == &graph && graph.WouldCreateCycle(*this, linkTarget))
+		return false;
 	return true;
 }
 bool GraphNode::CanLink(const std::string_view &outputName, GraphNode &linkTarget, const std::string_view &inputName) const
@@ -212,16 +224,19 @@ bool GraphNode::Link(uint32_t outputIdx, GraphNode &linkTarget, uint32_t inputId
 	}
 	if(!CanLink(outputIdx, linkTarget, inputIdx)) {
 		if(optOutErr)
-			*optOutErr = "Incompatible socket types!";
+			*optOutErr = (&linkTarget.graph == &graph && graph.WouldCreateCycle(*this, linkTarget)) ? "Link would create a cycle!" : "Incompatible socket types!";
 		return false;
 	}
-	Disconnect(outputIdx, linkTarget, inputIdx);
+	// The input may currently be linked to a different output
+	linkTarget.Disconnect(inputIdx);
 
 	auto &input = linkTarget.inputs[inputIdx];
 	auto &output = outputs[outputIdx];
 	output.links.push_back(&input);
 
 	input.link = &output;
+	linkTarget.MarkDirty();
+	linkTarget.graph.OnLinked(*this, linkTarget);
 	return true;
 }
 bool GraphNode::Link(const std::string_view &outputName, GraphNode &linkTarget, const std::string_view &inputName, std::string *optOutErr)
@@ -275,10 +290,83 @@ bool GraphNode::IsOutputLinked(const std::string_view &name) const
 	return !output->links.empty();
 }
 
-std::string GraphNode::GetBaseVarName() const { return "var" + util::to_string(nodeIndex); }
-std::string GraphNode::GetVarName(const std::string &var) const { return GetBaseVarName() + "_" + var; }
-std::string GraphNode::GetOutputVarName(size_t outputIdx) const { return GetVarName(util::to_string(outputIdx)); }
-std::string GraphNode::GetOutputVarName(const std::string_view &name) const
+hash::Hash GraphNode::GetStructuralHash() const
+{
+	if(m_structuralHashValid)
+		return m_structuralHash;
+	// Cyclic graphs can't be compiled anyway, we just have to make sure we don't recurse indefinitely
+	if(m_computingStructuralHash)
+		return 0;
+	m_computingStructuralHash = true;
+	auto h = hash::hash_string(node.GetType());
+	for(auto &input : inputs) {
+		if(input.link && input.link->parent) {
+			h = hash::hash_combine(h, 'L');
+			h = hash::hash_combine(h, input.link->parent->GetStructuralHash());
+			h = hash::hash_combine(h, input.link->outputIndex);
+			continue;
+		}
+		h = hash::hash_combine(h, 'C');
+		h = hash::hash_combine(h, input.GetValueHash());
+	}
+	m_computingStructuralHash = false;
+	m_structuralHash = h;
+	m_structuralHashValid = true;
+	return h;
+}
+void GraphNode::MarkDirty()
+{
+	// The downstream nodes were invalidated when this node was marked dirty
+	// (cached code is additionally validated by its signature, see Graph::EvaluateGlsl)
+	if(!m_structuralHashValid && m_dirty)
+		return;
+	m_structuralHashValid = false;
+	m_dirty = true;
+	for(auto &output : outputs) {
+		for(auto *link : output.links) {
+			// Nodes copied during code generation may still be linked to the nodes of the original graph, which must not be affected
+			if(&link->parent->graph != &graph)
+				continue;
+			link->parent->MarkDirty();
+		}
+	}
+}
+
+void GraphNode::SetNodeIndex(uint32_t index)
+{
+	nodeIndex = index;
+	auto baseName = "var" + util::to_string(index);
+	m_varNames.clear();
+	m_varNames.reserve((baseName.size() + 3) * (outputs.size() + 1));
+	m_varNameOffsets.clear();
+	m_varNameOffsets.reserve(outputs.size() + 1);
+	m_varNames += baseName;
+	m_varNameOffsets.push_back(m_varNames.size());
+	for(size_t i = 0; i < outputs.size(); ++i) {
+		m_varNames += baseName;
+		m_varNames += '_';
+		m_varNames += util::to_string(i);
+		m_varNameOffsets.push_back(m_varNames.size());
+	}
+}
+std::string GraphNode::GetVarName(const std::string_view &var) const
+{
+	std::string name;
+	auto baseName = GetBaseVarName();
+	name.reserve(baseName.size() + 1 + var.size());
+	name += baseName;
+	name += '_';
+	name += var;
+	return name;
+}
+std::string_view GraphNode::GetOutputVarName(size_t outputIdx) const
+{
+	if(outputIdx >= outputs.size())
+		throw std::invalid_argument {"Output index out of range!"};
+	auto start = m_varNameOffsets[outputIdx];
+	return std::string_view {m_varNames}.substr(start, m_varNameOffsets[outputIdx + 1] - start);
+}
+std::string_view GraphNode::GetOutputVarName(const std::string_view &name) const
 {
 	auto it = std::find_if(outputs.begin(), outputs.end(), [&name](const OutputSocket &output) { return output.GetSocket().name == name; });
 	if(it == outputs.end())
@@ -301,7 +389,17 @@ bool GraphNode::IsInputLinked(const std::string_view &name) const
 	return IsInputLinked(it - inputs.begin());
 }
 
-bool GraphNode::LoadFromAssetData(udm::LinkedPropertyWrapper &prop, std::vector<SocketLink> &outLinks, std::string &outErr)
+uint32_t GraphNode::LoadedLinks::StringTable::Intern(const std::string &str)
+{
+	auto it = indices.find(str);
+	if(it != indices.end())
+		return it->second;
+	auto idx = static_cast<uint32_t>(strings.size());
+	indices.emplace(strings.emplace_back(str), idx);
+	return idx;
+}
+
+bool GraphNode::LoadFromAssetData(udm::LinkedPropertyWrapper &prop, LoadedLinks &outLinks, std::string &outErr)
 {
 	prop["displayName"] >> m_displayName;
 	prop["pos"] >> m_pos;
@@ -337,13 +435,13 @@ bool GraphNode::LoadFromAssetData(udm::LinkedPropertyWrapper &prop, std::vector<
 
 		auto udmLink = udmInput["link"];
 		if(udmLink) {
-			if(outLinks.size() == outLinks.capacity())
-				outLinks.reserve(outLinks.size() * 1.5 + 100);
-			outLinks.push_back({});
-			auto &link = outLinks.back();
+			// The capacity is reserved by Graph::Load
+			auto &link = outLinks.links.emplace_back();
 			link.inputSocket = input;
-			udmLink["node"] >> link.outputNode;
-			udmLink["output"] >> link.outputName;
+			udmLink["node"] >> outLinks.buffer;
+			link.outputNode = outLinks.nodeNames.Intern(outLinks.buffer);
+			udmLink["output"] >> outLinks.buffer;
+			link.outputName = outLinks.outputNames.Intern(outLinks.buffer);
 		}
 	}
 	return true;
@@ -6,6 +6,7 @@ module;
 module pragma.shadergraph;
 
 import :node;
+import :code_writer;
 
 using namespace pragma::shadergraph;
 
@@ -14,17 +15,28 @@ Node::~Node() {}
 
 const std::string_view &Node::GetType() const { return m_type; }
 const std::string_view &Node::GetCategory() const { return m_category; }
+void Node::EvaluateResourceDeclarations(const Graph &graph, const GraphNode &instance, CodeWriter &writer) const { DoEvaluateResourceDeclarations(graph, instance, writer); }
+void Node::Evaluate(const Graph &graph, const GraphNode &instance, CodeWriter &writer) const { DoEvaluate(graph, instance, writer); }
 std::string Node::EvaluateResourceDeclarations(const Graph &graph, const GraphNode &instance) const
 {
-	auto res = DoEvaluateResourceDeclarations(graph, instance);
-	//m_curVarId = 0;
-	return res;
+	CodeWriter writer;
+	EvaluateResourceDeclarations(graph, instance, writer);
+	return writer.str();
 }
 std::string Node::Evaluate(const Graph &graph, const GraphNode &instance) const
 {
-	auto res = DoEvaluate(graph, instance);
-	//m_curVarId = 0;
-	return res;
+	CodeWriter writer;
+	Evaluate(graph, instance, writer);
+	return writer.str();
+}
+void Node::EvaluateKernel(const KernelArgs &args) const { DoEvaluateKernel(args); }
+void Node::EvaluateKernelBatch(const BatchKernelArgs &args) const { DoEvaluateKernelBatch(args); }
+void Node::DoEvaluateKernel(const KernelArgs &args) const { throw std::logic_error {"Node type '" + std::string {m_type} + "' has no CPU kernel!"}; }
+void Node::DoEvaluateKernelBatch(const BatchKernelArgs &args) const
+{
+	auto laneCount = args.GetLaneCount();
+	for(uint32_t i = 0; i < laneCount; ++i)
+		DoEvaluateKernel(args.GetLane(i));
 }
 Socket &Node::AddOutput(const std::string &name, DataType type)
 {
@@ -37,7 +49,10 @@ std::string Node::GetGlslOutputDeclaration(const GraphNode &instance, uint32_t o
 	if(outputIdx >= m_outputs.size())
 		throw std::invalid_argument {"Output index out of range!"};
 	auto &output = m_outputs[outputIdx];
-	return std::string {to_glsl_type(output.type)} + " " + instance.GetOutputVarName(output.name);
+	std::string decl {to_glsl_type(output.type)};
+	decl += ' ';
+	decl += instance.GetOutputVarName(outputIdx);
+	return decl;
 }
 std::string Node::GetGlslOutputDeclaration(const GraphNode &instance, const std::string_view &name) const
 {
@@ -61,23 +76,19 @@ const std::vector<Socket> &Node::GetInputs() const { return m_inputs; }
 const std::vector<Socket> &Node::GetOutputs() const { return m_outputs; }
 const Socket *Node::GetInput(size_t index) const { return (index < m_inputs.size()) ? &m_inputs[index] : nullptr; }
 const Socket *Node::GetOutput(size_t index) const { return (index < m_outputs.size()) ? &m_outputs[index] : nullptr; }
+bool Node::IsEnumInputValue(uint32_t inputIdx, uint32_t value) const
+{
+	auto *input = GetInput(inputIdx);
+	if(!input || !input->enumSet || value > static_cast<uint32_t>(std::numeric_limits<int32_t>::max()))
+		return false;
+	return input->enumSet->exists(static_cast<int32_t>(value));
+}
 
 std::string Node::GetConstantValue(const GraphNode &instance, uint32_t inputIdx) const
 {
-	std::string val;
-	auto &input = instance.inputs.at(inputIdx);
-	visit(input.GetSocket().type, [&input, &val](auto tag) {
-		using T = typename decltype(tag)::type;
-		if constexpr(is_data_type<T>() && !std::is_same_v<T, udm::String>) {
-			T v;
-			if(!input.GetValue(v))
-				throw std::invalid_argument {"Failed to retrieve input value!"};
-			val = to_glsl_value<T>(v);
-		}
-		else
-			throw std::invalid_argument {"Socket type '" + std::string {magic_enum::enum_name(input.GetSocket().type)} + "' cannot be converted to GLSL!"};
-	});
-	return val;
+	CodeWriter writer;
+	writer << glsl::ConstantValue {instance, inputIdx};
+	return writer.str();
 }
 std::string Node::GetConstantValue(const GraphNode &instance, const std::string_view &inputName) const
 {
@@ -88,13 +99,9 @@ std::string Node::GetConstantValue(const GraphNode &instance, const std::string_
 }
 std::string Node::GetInputNameOrValue(const GraphNode &instance, uint32_t inputIdx) const
 {
-	std::string val;
-	auto &input = instance.inputs.at(inputIdx);
-	if(input.link && input.link->parent)
-		val = input.link->parent->GetOutputVarName(input.link->outputIndex);
-	else
-		val = GetConstantValue(instance, inputIdx);
-	return val;
+	CodeWriter writer;
+	writer << glsl::InputNameOrValue {instance, inputIdx};
+	return writer.str();
 }
 std::string Node::GetInputNameOrValue(const GraphNode &instance, const std::string_view &inputName) const
 {
@@ -103,6 +110,11 @@ std::string Node::GetInputNameOrValue(const GraphNode &instance, const std::stri
 		throw std::invalid_argument {"No input named '" + std::string {inputName} + "' exists!"};
 	return GetInputNameOrValue(instance, it - m_inputs.begin());
 }
+void Node::ValidateHandle(const std::vector<Socket> &sockets, const std::string_view &name, uint32_t index) const
+{
+	if(index != sockets.size())
+		throw std::logic_error {"Handle of socket '" + std::string {name} + "' of node type '" + std::string {m_type} + "' has index " + util::to_string(index) + ", but the socket is added at index " + util::to_string(sockets.size()) + "!"};
+}
 Socket &Node::AddSocket(const std::string &name, DataType type, float min, float max)
 {
 	m_inputs.emplace_back(name, type);
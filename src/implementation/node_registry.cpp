@@ -31,4 +31,41 @@ void NodeRegistry::GetNodeTypes(std::vector<std::string> &outNames) const
 	for(auto &child : m_childRegistries)
 		child->GetNodeTypes(outNames);
 }
-void NodeRegistry::RegisterNode(const std::string &name, const std::shared_ptr<Node> &node) { m_nodes[name] = node; }
+static hash::Hash hash_socket(const Socket &socket, hash::Hash h)
+{
+	h = hash::hash_string(socket.name, h);
+	h = hash::hash_combine(h, math::to_integral(socket.type));
+	h = hash::hash_combine(h, math::to_integral(socket.flags));
+	return hash::hash_combine(h, socket.defaultValue.GetHash());
+}
+static hash::Hash hash_node(const std::string &name, const Node &node)
+{
+	auto h = hash::hash_string(name);
+	h = hash::hash_string(node.GetType(), h);
+	h = hash::hash_string(node.GetCategory(), h);
+	for(auto &input : node.GetInputs())
+		h = hash_socket(input, h);
+	h = hash::hash_combine(h, node.GetInputs().size());
+	for(auto &output : node.GetOutputs())
+		h = hash_socket(output, h);
+	h = hash::hash_combine(h, node.GetOutputs().size());
+	for(auto &dep : node.GetModuleDependencies())
+		h = hash::hash_string(dep, h);
+	return h;
+}
+void NodeRegistry::RegisterNode(const std::string &name, const std::shared_ptr<Node> &node)
+{
+	auto &entry = m_nodes[name];
+	if(entry)
+		m_nodeHashSum -= hash_node(name, *entry);
+	entry = node;
+	m_nodeHashSum += hash_node(name, *node);
+}
+hash::Hash NodeRegistry::GetFingerprint() const
+{
+	// Child registries may change independently, so their fingerprints are combined on demand
+	auto h = hash::hash_combine(hash::hash_value(m_nodes.size()), m_nodeHashSum);
+	for(auto &child : m_childRegistries)
+		h = hash::hash_combine(h, child->GetFingerprint());
+	return h;
+}
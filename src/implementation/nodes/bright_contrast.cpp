@@ -18,24 +18,30 @@ BrightContrastNode::BrightContrastNode(const std::string_view &type) : Node {typ
 	AddOutput(OUT_COLOR, DataType::Color);
 }
 
-std::string BrightContrastNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void BrightContrastNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
-	auto brightness = gn.GetInputNameOrValue(IN_BRIGHT);
-	auto contrast = gn.GetInputNameOrValue(IN_CONTRAST);
+	glsl::InputNameOrValue color {gn, IN_COLOR};
+	glsl::InputNameOrValue brightness {gn, IN_BRIGHT};
+	glsl::InputNameOrValue contrast {gn, IN_CONTRAST};
 
-	auto a = gn.GetVarName("a");
-	auto b = gn.GetVarName("b");
+	glsl::VarName a {gn, "a"};
+	glsl::VarName b {gn, "b"};
 
 	code << "float " << a << " = 1.0f + " << contrast << ";\n";
 	code << "float " << b << " = " << brightness << " - " << contrast << " * 0.5f;\n";
 
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = vec3(\n";
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = vec3(\n";
 	code << "max(" << a << " * " << color << ".x + " << b << ", 0.0f),\n";
 	code << "max(" << a << " * " << color << ".y + " << b << ", 0.0f),\n";
 	code << "max(" << a << " * " << color << ".z + " << b << ", 0.0f)\n";
 	code << ");\n";
+}
 
-	return code.str();
+void BrightContrastNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto contrast = args.GetFloat(IN_CONTRAST.index);
+	auto a = 1.f + contrast;
+	auto b = args.GetFloat(IN_BRIGHT.index) - contrast * 0.5f;
+	auto color = args.GetVector3(IN_COLOR.index);
+	args.SetVector3(OUT_COLOR.index, kernel::max(a * color + Vector3 {b, b, b}, 0.f));
 }
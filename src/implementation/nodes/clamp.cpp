@@ -20,16 +20,15 @@ ClampNode::ClampNode(const std::string_view &type) : Node {type, CATEGORY_MATH}
 	AddOutput(OUT_RESULT, DataType::Float);
 }
 
-std::string ClampNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void ClampNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto value = gn.GetInputNameOrValue(IN_VALUE);
-	auto min = gn.GetInputNameOrValue(IN_MIN);
-	auto max = gn.GetInputNameOrValue(IN_MAX);
+	glsl::InputNameOrValue value {gn, IN_VALUE};
+	glsl::InputNameOrValue min {gn, IN_MIN};
+	glsl::InputNameOrValue max {gn, IN_MAX};
 	auto clampType = *gn.GetConstantInputValue<ClampType>(CONST_CLAMP_TYPE);
 
-	code << gn.GetGlslOutputDeclaration(OUT_RESULT) << ";\n";
-	auto outVar = gn.GetOutputVarName(OUT_RESULT);
+	code << glsl::OutputDeclaration {gn, OUT_RESULT} << ";\n";
+	glsl::OutputVarName outVar {gn, OUT_RESULT};
 
 	switch(clampType) {
 	case ClampType::MinMax:
@@ -42,5 +41,16 @@ std::string ClampNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
 		code << "\t" << outVar << " = clamp(" << value << ", " << min << ", " << max << ");\n";
 		break;
 	}
-	return code.str();
+}
+
+uint32_t ClampNode::GetKernelVariant(const GraphNode &gn) const { return math::to_integral(*gn.GetConstantInputValue<ClampType>(CONST_CLAMP_TYPE)); }
+
+void ClampNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto value = args.GetFloat(IN_VALUE.index);
+	auto min = args.GetFloat(IN_MIN.index);
+	auto max = args.GetFloat(IN_MAX.index);
+	if(args.GetVariant<ClampType>() == ClampType::Range && min > max)
+		std::swap(min, max);
+	args.SetFloat(OUT_RESULT.index, kernel::clamp(value, min, max));
 }
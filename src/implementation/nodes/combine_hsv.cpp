@@ -20,15 +20,15 @@ CombineHsvNode::CombineHsvNode(const std::string_view &type) : Node {type, CATEG
 	AddModuleDependency("color");
 }
 
-std::string CombineHsvNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void CombineHsvNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto h = gn.GetInputNameOrValue(IN_H);
-	auto s = gn.GetInputNameOrValue(IN_S);
-	auto v = gn.GetInputNameOrValue(IN_V);
+	glsl::InputNameOrValue h {gn, IN_H};
+	glsl::InputNameOrValue s {gn, IN_S};
+	glsl::InputNameOrValue v {gn, IN_V};
 
-	auto color = gn.GetVarName("color");
+	glsl::VarName color {gn, "color"};
 	code << "vec3 " << color << " = hsv_to_rgb(vec3(" << h << ", " << s << ", " << v << "));\n";
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = " << color << ";\n";
-	return code.str();
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = " << color << ";\n";
 }
+
+void CombineHsvNode::DoEvaluateKernel(const KernelArgs &args) const { args.SetVector3(OUT_COLOR.index, kernel::hsv_to_rgb(Vector3 {args.GetFloat(IN_H.index), args.GetFloat(IN_S.index), args.GetFloat(IN_V.index)})); }
@@ -18,13 +18,13 @@ CombineXyzNode::CombineXyzNode(const std::string_view &type) : Node {type, CATEG
 	AddOutput(OUT_VECTOR, DataType::Vector);
 }
 
-std::string CombineXyzNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void CombineXyzNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	code << gn.GetGlslOutputDeclaration(OUT_VECTOR) << " = ";
-	auto x = gn.GetInputNameOrValue(IN_X);
-	auto y = gn.GetInputNameOrValue(IN_Y);
-	auto z = gn.GetInputNameOrValue(IN_Z);
+	code << glsl::OutputDeclaration {gn, OUT_VECTOR} << " = ";
+	glsl::InputNameOrValue x {gn, IN_X};
+	glsl::InputNameOrValue y {gn, IN_Y};
+	glsl::InputNameOrValue z {gn, IN_Z};
 	code << "vec3(" << x << ", " << y << ", " << z << ");\n";
-	return code.str();
 }
+
+void CombineXyzNode::DoEvaluateKernel(const KernelArgs &args) const { args.SetVector3(OUT_VECTOR.index, Vector3 {args.GetFloat(IN_X.index), args.GetFloat(IN_Y.index), args.GetFloat(IN_Z.index)}); }
@@ -24,22 +24,20 @@ EmissionNode::EmissionNode(const std::string_view &type) : Node {type, CATEGORY_
 	AddModuleDependency("emission");
 }
 
-std::string EmissionNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void EmissionNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto emissionColor = gn.GetVarName("emissionColor");
+	glsl::VarName emissionColor {gn, "emissionColor"};
 	code << "vec3 " << emissionColor << " = ";
 	code << "apply_emission_color(";
-	code << "vec4(" << gn.GetInputNameOrValue(IN_COLOR) << ", 1.0)" << ", ";
-	code << "vec4(" << gn.GetInputNameOrValue(IN_EMISSION_COLOR) << " *" << gn.GetInputNameOrValue(IN_EMISSION_FACTOR) << ", 1.0)" << ", ";
-	code << "vec4(" << gn.GetInputNameOrValue(IN_BASE_COLOR) << ", 1.0)" << ", ";
-	code << gn.GetInputNameOrValue(IN_EMISSION_MODE);
+	code << "vec4(" << glsl::InputNameOrValue {gn, IN_COLOR} << ", 1.0)" << ", ";
+	code << "vec4(" << glsl::InputNameOrValue {gn, IN_EMISSION_COLOR} << " *" << glsl::InputNameOrValue {gn, IN_EMISSION_FACTOR} << ", 1.0)" << ", ";
+	code << "vec4(" << glsl::InputNameOrValue {gn, IN_BASE_COLOR} << ", 1.0)" << ", ";
+	code << glsl::InputNameOrValue {gn, IN_EMISSION_MODE};
 	code << ").rgb;\n";
 
-	auto emissionAlpha = gn.GetInputNameOrValue(IN_EMISSION_ALPHA);
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = mix(" << gn.GetInputNameOrValue(IN_COLOR) << ", " << emissionColor << ", " << emissionAlpha << ");\n";
+	glsl::InputNameOrValue emissionAlpha {gn, IN_EMISSION_ALPHA};
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = mix(" << glsl::InputNameOrValue {gn, IN_COLOR} << ", " << emissionColor << ", " << emissionAlpha << ");\n";
 
-	code << gn.GetGlslOutputDeclaration(OUT_EMISSION_COLOR) << " = ";
-	code << gn.GetInputNameOrValue(IN_EMISSION_COLOR) << " *" << gn.GetInputNameOrValue(IN_EMISSION_FACTOR) << " *" << emissionAlpha << ";\n";
-	return code.str();
+	code << glsl::OutputDeclaration {gn, OUT_EMISSION_COLOR} << " = ";
+	code << glsl::InputNameOrValue {gn, IN_EMISSION_COLOR} << " *" << glsl::InputNameOrValue {gn, IN_EMISSION_FACTOR} << " *" << emissionAlpha << ";\n";
 }
@@ -17,25 +17,36 @@ GammaNode::GammaNode(const std::string_view &type) : Node {type, CATEGORY_COLOR}
 	AddOutput(OUT_COLOR, DataType::Color);
 }
 
-std::string GammaNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void GammaNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
-	auto gamma = gn.GetInputNameOrValue(IN_GAMMA);
+	glsl::InputNameOrValue color {gn, IN_COLOR};
+	glsl::InputNameOrValue gamma {gn, IN_GAMMA};
 
-	auto outVar = gn.GetOutputVarName(OUT_COLOR);
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << ";\n";
+	glsl::OutputVarName outVar {gn, OUT_COLOR};
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << ";\n";
 	code << "if (" << gamma << " == 0.0f)\n";
 	code << "\t" << outVar << " = vec3(1.0f, 1.0f, 1.0f);\n";
 	code << "else\n";
 	code << "{\n";
-	code << "\tif (" << color << ".x > 0.0f)\n";
-	code << "\t\t" << color << ".x = pow(" << color << ".x, " << gamma << ");\n";
-	code << "\tif (" << color << ".y > 0.0f)\n";
-	code << "\t\t" << color << ".y = pow(" << color << ".y, " << gamma << ");\n";
-	code << "\tif (" << color << ".z > 0.0f)\n";
-	code << "\t\t" << color << ".z = pow(" << color << ".z, " << gamma << ");\n";
+	// The input may be a literal or the output of another node, so only the output variable is modified
 	code << "\t" << outVar << " = " << color << ";\n";
+	code << "\tif (" << outVar << ".x > 0.0f)\n";
+	code << "\t\t" << outVar << ".x = pow(" << outVar << ".x, " << gamma << ");\n";
+	code << "\tif (" << outVar << ".y > 0.0f)\n";
+	code << "\t\t" << outVar << ".y = pow(" << outVar << ".y, " << gamma << ");\n";
+	code << "\tif (" << outVar << ".z > 0.0f)\n";
+	code << "\t\t" << outVar << ".z = pow(" << outVar << ".z, " << gamma << ");\n";
 	code << "}\n";
-	return code.str();
+}
+
+void GammaNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto gamma = args.GetFloat(IN_GAMMA.index);
+	if(gamma == 0.f) {
+		args.SetVector3(OUT_COLOR.index, Vector3 {1.f, 1.f, 1.f});
+		return;
+	}
+	auto color = args.GetVector3(IN_COLOR.index);
+	auto applyGamma = [gamma](float c) -> float { return (c > 0.f) ? std::pow(c, gamma) : c; };
+	args.SetVector3(OUT_COLOR.index, Vector3 {applyGamma(color.x), applyGamma(color.y), applyGamma(color.z)});
 }
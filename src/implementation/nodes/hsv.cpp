@@ -22,23 +22,34 @@ HsvNode::HsvNode(const std::string_view &type) : Node {type, CATEGORY_COLOR}
 	AddModuleDependency("color");
 }
 
-std::string HsvNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void HsvNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto hue = gn.GetInputNameOrValue(IN_HUE);
-	auto saturation = gn.GetInputNameOrValue(IN_SATURATION);
-	auto value = gn.GetInputNameOrValue(IN_VALUE);
-	auto fac = gn.GetInputNameOrValue(IN_FAC);
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
-
-	auto hsv = gn.GetVarName("hsv");
+	glsl::InputNameOrValue hue {gn, IN_HUE};
+	glsl::InputNameOrValue saturation {gn, IN_SATURATION};
+	glsl::InputNameOrValue value {gn, IN_VALUE};
+	glsl::InputNameOrValue fac {gn, IN_FAC};
+	glsl::InputNameOrValue color {gn, IN_COLOR};
+
+	glsl::VarName hsv {gn, "hsv"};
 	code << "vec3 " << hsv << " = rgb_to_hsv(" << color << ");\n";
 	code << hsv << ".x = mod(" << hsv << ".x + " << hue << " + 0.5, 1.0);\n";
 	code << hsv << ".y = clamp(" << hsv << ".y * " << saturation << ", 0.0, 1.0);\n";
 	code << hsv << ".z *= " << value << ";\n";
-	code << color << " = hsv_to_rgb(" << hsv << ");\n";
-	code << color << " = " << fac << " * " << color << " + (1.0 - " << fac << ") * " << color << ";\n";
-	code << color << " = max(" << color << ", vec3(0.0));\n";
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = " << color << ";\n";
-	return code.str();
+	// The input may be a literal, so the result is written to a local variable instead
+	glsl::VarName rgb {gn, "rgb"};
+	code << "vec3 " << rgb << " = hsv_to_rgb(" << hsv << ");\n";
+	code << rgb << " = " << fac << " * " << rgb << " + (1.0 - " << fac << ") * " << color << ";\n";
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = max(" << rgb << ", vec3(0.0));\n";
+}
+
+void HsvNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto color = args.GetVector3(IN_COLOR.index);
+	auto fac = args.GetFloat(IN_FAC.index);
+	auto hsv = kernel::rgb_to_hsv(color);
+	hsv.x = kernel::mod(hsv.x + args.GetFloat(IN_HUE.index) + 0.5f, 1.f);
+	hsv.y = kernel::clamp(hsv.y * args.GetFloat(IN_SATURATION.index), 0.f, 1.f);
+	hsv.z *= args.GetFloat(IN_VALUE.index);
+	auto result = fac * kernel::hsv_to_rgb(hsv) + (1.f - fac) * color;
+	args.SetVector3(OUT_COLOR.index, kernel::max(result, 0.f));
 }
@@ -17,13 +17,17 @@ InvertNode::InvertNode(const std::string_view &type) : Node {type, CATEGORY_COLO
 	AddOutput(OUT_COLOR, DataType::Color);
 }
 
-std::string InvertNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void InvertNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto fac = gn.GetInputNameOrValue(IN_FAC);
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
+	glsl::InputNameOrValue fac {gn, IN_FAC};
+	glsl::InputNameOrValue color {gn, IN_COLOR};
 
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = ";
 	code << "mix(" << color << ", vec3(1.0) - " << color << ", " << fac << ");\n";
-	return code.str();
+}
+
+void InvertNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto color = args.GetVector3(IN_COLOR.index);
+	args.SetVector3(OUT_COLOR.index, kernel::mix(color, Vector3 {1.f, 1.f, 1.f} - color, args.GetFloat(IN_FAC.index)));
 }
@@ -33,23 +33,21 @@ void MapRangeNode::Expand(Graph &graph, GraphNode &gn) const
 	gn.PropagateInputSocket(IN_TO_MAX, *clamp, ClampNode::IN_MAX);
 }
 
-std::string MapRangeNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void MapRangeNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-
-	auto value = gn.GetInputNameOrValue(IN_VALUE);
-	auto fromMin = gn.GetInputNameOrValue(IN_FROM_MIN);
-	auto fromMax = gn.GetInputNameOrValue(IN_FROM_MAX);
-	auto toMin = gn.GetInputNameOrValue(IN_TO_MIN);
-	auto toMax = gn.GetInputNameOrValue(IN_TO_MAX);
-	auto steps = gn.GetInputNameOrValue(IN_STEPS);
-	auto clamp = gn.GetInputNameOrValue(IN_CLAMP);
+	glsl::InputNameOrValue value {gn, IN_VALUE};
+	glsl::InputNameOrValue fromMin {gn, IN_FROM_MIN};
+	glsl::InputNameOrValue fromMax {gn, IN_FROM_MAX};
+	glsl::InputNameOrValue toMin {gn, IN_TO_MIN};
+	glsl::InputNameOrValue toMax {gn, IN_TO_MAX};
+	glsl::InputNameOrValue steps {gn, IN_STEPS};
+	glsl::InputNameOrValue clamp {gn, IN_CLAMP};
 
 	auto type = *gn.GetConstantInputValue<Type>(CONST_TYPE);
-	code << gn.GetGlslOutputDeclaration(OUT_RESULT) << ";\n";
-	auto outVar = gn.GetOutputVarName(OUT_RESULT);
+	code << glsl::OutputDeclaration {gn, OUT_RESULT} << ";\n";
+	glsl::OutputVarName outVar {gn, OUT_RESULT};
 	code << "if(compare(" << fromMax << ", " << fromMin << ")) {\n";
-	auto factor = gn.GetVarName("factor");
+	glsl::VarName factor {gn, "factor"};
 	code << "\tfloat " << factor << ";\n";
 	switch(type) {
 	case Type::Linear:
@@ -71,5 +69,37 @@ std::string MapRangeNode::DoEvaluate(const Graph &graph, const GraphNode &gn) co
 	code << "} else {\n";
 	code << "\t" << outVar << " = 0.0;\n";
 	code << "}\n";
-	return code.str();
+}
+
+uint32_t MapRangeNode::GetKernelVariant(const GraphNode &gn) const { return math::to_integral(*gn.GetConstantInputValue<Type>(CONST_TYPE)); }
+
+void MapRangeNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto value = args.GetFloat(IN_VALUE.index);
+	auto fromMin = args.GetFloat(IN_FROM_MIN.index);
+	auto fromMax = args.GetFloat(IN_FROM_MAX.index);
+	auto toMin = args.GetFloat(IN_TO_MIN.index);
+	auto toMax = args.GetFloat(IN_TO_MAX.index);
+	auto steps = args.GetFloat(IN_STEPS.index);
+	if(!kernel::compare(fromMax, fromMin)) {
+		args.SetFloat(OUT_RESULT.index, 0.f);
+		return;
+	}
+	auto factor = 0.f;
+	switch(args.GetVariant<Type>()) {
+	case Type::Linear:
+		factor = (value - fromMin) / (fromMax - fromMin);
+		break;
+	case Type::Stepped:
+		factor = (value - fromMin) / (fromMax - fromMin);
+		factor = (steps > 0.f) ? std::floor(factor * (steps + 1.f)) / steps : 0.f;
+		break;
+	case Type::Smoothstep:
+		factor = (fromMin > fromMax) ? 1.f - kernel::smoothstep(fromMax, fromMin, value) : kernel::smoothstep(fromMin, fromMax, value);
+		break;
+	case Type::Smootherstep:
+		factor = (fromMin > fromMax) ? 1.f - kernel::smootherstep(fromMax, fromMin, value) : kernel::smootherstep(fromMin, fromMax, value);
+		break;
+	}
+	args.SetFloat(OUT_RESULT.index, toMin + factor * (toMax - toMin));
 }
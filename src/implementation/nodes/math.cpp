@@ -22,13 +22,12 @@ MathNode::MathNode(const std::string_view &type) : Node {type, CATEGORY_MATH}
 	AddModuleDependency("math");
 }
 
-std::string MathNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void MathNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	code << gn.GetGlslOutputDeclaration(OUT_VALUE) << " = ";
-	auto v1 = gn.GetInputNameOrValue(IN_VALUE1);
-	auto v2 = gn.GetInputNameOrValue(IN_VALUE2);
-	auto v3 = gn.GetInputNameOrValue(IN_VALUE3);
+	code << glsl::OutputDeclaration {gn, OUT_VALUE} << " = ";
+	glsl::InputNameOrValue v1 {gn, IN_VALUE1};
+	glsl::InputNameOrValue v2 {gn, IN_VALUE2};
+	glsl::InputNameOrValue v3 {gn, IN_VALUE3};
 	auto op = *gn.GetConstantInputValue<Operation>(IN_OPERATION);
 	switch(op) {
 	case Operation::Add:
@@ -157,11 +156,254 @@ std::string MathNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
 	}
 	code << ";\n";
 
-	auto clamp = gn.GetInputNameOrValue(IN_CLAMP);
+	glsl::InputNameOrValue clamp {gn, IN_CLAMP};
 	auto constClamp = gn.GetConstantInputValue<bool>(IN_CLAMP);
 	if(!constClamp.has_value() || *constClamp) {
-		auto outVarName = gn.GetOutputVarName(OUT_VALUE);
+		glsl::OutputVarName outVarName {gn, OUT_VALUE};
 		code << outVarName << " = (" << clamp << " > 0.5) ? clamp(" << outVarName << ", 0.0, 1.0) : " << outVarName << ";\n";
 	}
-	return code.str();
+}
+
+uint32_t MathNode::GetKernelVariant(const GraphNode &gn) const { return math::to_integral(*gn.GetConstantInputValue<Operation>(IN_OPERATION)); }
+
+void MathNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto v1 = args.GetFloat(IN_VALUE1.index);
+	auto v2 = args.GetFloat(IN_VALUE2.index);
+	auto v3 = args.GetFloat(IN_VALUE3.index);
+	float result;
+	switch(args.GetVariant<Operation>()) {
+	case Operation::Add:
+		result = v1 + v2;
+		break;
+	case Operation::Subtract:
+		result = v1 - v2;
+		break;
+	case Operation::Multiply:
+		result = v1 * v2;
+		break;
+	case Operation::Divide:
+		result = v1 / v2;
+		break;
+	case Operation::MultiplyAdd:
+		result = v1 * v2 + v3;
+		break;
+	case Operation::Sine:
+		result = std::sin(v1);
+		break;
+	case Operation::Cosine:
+		result = std::cos(v1);
+		break;
+	case Operation::Tangent:
+		result = std::tan(v1);
+		break;
+	case Operation::SinH:
+		result = std::sinh(v1);
+		break;
+	case Operation::CosH:
+		result = std::cosh(v1);
+		break;
+	case Operation::TanH:
+		result = std::tanh(v1);
+		break;
+	case Operation::ArcSine:
+		result = std::asin(v1);
+		break;
+	case Operation::ArcCosine:
+		result = std::acos(v1);
+		break;
+	case Operation::ArcTangent:
+		result = std::atan(v1);
+		break;
+	case Operation::Power:
+		result = std::pow(v1, v2);
+		break;
+	case Operation::Logarithm:
+		result = std::log(v1);
+		break;
+	case Operation::Minimum:
+		result = std::min(v1, v2);
+		break;
+	case Operation::Maximum:
+		result = std::max(v1, v2);
+		break;
+	case Operation::Round:
+		result = std::nearbyint(v1);
+		break;
+	case Operation::LessThan:
+		result = std::max(kernel::sign(v2 - v1), 0.f);
+		break;
+	case Operation::GreaterThan:
+		result = std::max(kernel::sign(v1 - v2), 0.f);
+		break;
+	case Operation::Modulo:
+	case Operation::FlooredModulo:
+		result = kernel::mod(v1, v2);
+		break;
+	case Operation::Absolute:
+		result = std::abs(v1);
+		break;
+	case Operation::ArcTan2:
+		result = std::atan2(v1, v2);
+		break;
+	case Operation::Floor:
+		result = std::floor(v1);
+		break;
+	case Operation::Ceil:
+		result = std::ceil(v1);
+		break;
+	case Operation::Fraction:
+		result = kernel::fract(v1);
+		break;
+	case Operation::Trunc:
+		result = std::trunc(v1);
+		break;
+	case Operation::Snap:
+		result = std::floor(v1 / v2) * v2;
+		break;
+	case Operation::Wrap:
+		result = kernel::wrap(v1, v2, v3);
+		break;
+	case Operation::PingPong:
+		result = kernel::pingpong(v1, v2);
+		break;
+	case Operation::Sqrt:
+		result = std::sqrt(v1);
+		break;
+	case Operation::InverseSqrt:
+		result = 1.f / std::sqrt(v1);
+		break;
+	case Operation::Sign:
+		result = kernel::sign(v1);
+		break;
+	case Operation::Exponent:
+		result = std::exp(v1);
+		break;
+	case Operation::Radians:
+		result = v1 * (kernel::PI / 180.f);
+		break;
+	case Operation::Degrees:
+		result = v1 * (180.f / kernel::PI);
+		break;
+	case Operation::SmoothMin:
+		result = kernel::smoothmin(v1, v2, v3);
+		break;
+	case Operation::SmoothMax:
+		result = -kernel::smoothmin(-v1, -v2, v3);
+		break;
+	case Operation::Compare:
+		result = (std::abs(v1 - v2) <= std::max(v3, kernel::FLOAT_EPSILON)) ? 1.f : 0.f;
+		break;
+	default:
+		result = 0.f;
+		break;
+	}
+	if(args.GetBool(IN_CLAMP.index))
+		result = kernel::clamp(result, 0.f, 1.f);
+	args.SetFloat(OUT_VALUE.index, result);
+}
+
+void MathNode::DoEvaluateKernelBatch(const BatchKernelArgs &args) const
+{
+	namespace simd = kernel::simd;
+	auto *v1 = args.GetInputStream(IN_VALUE1.index);
+	auto *v2 = args.GetInputStream(IN_VALUE2.index);
+	auto *v3 = args.GetInputStream(IN_VALUE3.index);
+	auto *out = args.GetOutputStream(OUT_VALUE.index);
+	auto laneCount = args.GetLaneCount();
+	auto unary = [v1, out, laneCount](auto op) {
+		for(uint32_t i = 0; i < laneCount; i += simd::WIDTH)
+			simd::store(out + i, op(simd::load(v1 + i)));
+	};
+	auto binary = [v1, v2, out, laneCount](auto op) {
+		for(uint32_t i = 0; i < laneCount; i += simd::WIDTH)
+			simd::store(out + i, op(simd::load(v1 + i), simd::load(v2 + i)));
+	};
+	auto ternary = [v1, v2, v3, out, laneCount](auto op) {
+		for(uint32_t i = 0; i < laneCount; i += simd::WIDTH)
+			simd::store(out + i, op(simd::load(v1 + i), simd::load(v2 + i), simd::load(v3 + i)));
+	};
+	switch(args.GetVariant<Operation>()) {
+	case Operation::Add:
+		binary([](simd::Float a, simd::Float b) { return simd::add(a, b); });
+		break;
+	case Operation::Subtract:
+		binary([](simd::Float a, simd::Float b) { return simd::sub(a, b); });
+		break;
+	case Operation::Multiply:
+		binary([](simd::Float a, simd::Float b) { return simd::mul(a, b); });
+		break;
+	case Operation::Divide:
+		binary([](simd::Float a, simd::Float b) { return simd::div(a, b); });
+		break;
+	case Operation::MultiplyAdd:
+		ternary([](simd::Float a, simd::Float b, simd::Float c) { return simd::add(simd::mul(a, b), c); });
+		break;
+	case Operation::Minimum:
+		binary([](simd::Float a, simd::Float b) { return simd::min(a, b); });
+		break;
+	case Operation::Maximum:
+		binary([](simd::Float a, simd::Float b) { return simd::max(a, b); });
+		break;
+	case Operation::Round:
+		unary([](simd::Float a) { return simd::round(a); });
+		break;
+	case Operation::LessThan:
+		binary([](simd::Float a, simd::Float b) { return simd::select(simd::less(a, b), simd::set1(1.f), simd::set1(0.f)); });
+		break;
+	case Operation::GreaterThan:
+		binary([](simd::Float a, simd::Float b) { return simd::select(simd::greater(a, b), simd::set1(1.f), simd::set1(0.f)); });
+		break;
+	case Operation::Modulo:
+	case Operation::FlooredModulo:
+		binary([](simd::Float a, simd::Float b) { return simd::mod(a, b); });
+		break;
+	case Operation::Absolute:
+		unary([](simd::Float a) { return simd::abs(a); });
+		break;
+	case Operation::Floor:
+		unary([](simd::Float a) { return simd::floor(a); });
+		break;
+	case Operation::Ceil:
+		unary([](simd::Float a) { return simd::ceil(a); });
+		break;
+	case Operation::Fraction:
+		unary([](simd::Float a) { return simd::fract(a); });
+		break;
+	case Operation::Trunc:
+		unary([](simd::Float a) { return simd::trunc(a); });
+		break;
+	case Operation::Snap:
+		binary([](simd::Float a, simd::Float b) { return simd::mul(simd::floor(simd::div(a, b)), b); });
+		break;
+	case Operation::Sqrt:
+		unary([](simd::Float a) { return simd::sqrt(a); });
+		break;
+	case Operation::InverseSqrt:
+		unary([](simd::Float a) { return simd::div(simd::set1(1.f), simd::sqrt(a)); });
+		break;
+	case Operation::Sign:
+		unary([](simd::Float a) { return simd::sign(a); });
+		break;
+	case Operation::Radians:
+		unary([](simd::Float a) { return simd::mul(a, simd::set1(kernel::PI / 180.f)); });
+		break;
+	case Operation::Degrees:
+		unary([](simd::Float a) { return simd::mul(a, simd::set1(180.f / kernel::PI)); });
+		break;
+	case Operation::Compare:
+		ternary([](simd::Float a, simd::Float b, simd::Float c) { return simd::select(simd::less_equal(simd::abs(simd::sub(a, b)), simd::max(c, simd::set1(kernel::FLOAT_EPSILON))), simd::set1(1.f), simd::set1(0.f)); });
+		break;
+	default:
+		// No vectorized implementation (e.g. transcendental functions), fall back to the scalar kernel
+		Node::DoEvaluateKernelBatch(args);
+		return;
+	}
+
+	auto *clamp = args.GetInputStream(IN_CLAMP.index);
+	for(uint32_t i = 0; i < laneCount; i += simd::WIDTH) {
+		auto v = simd::load(out + i);
+		auto clamped = simd::clamp(v, simd::set1(0.f), simd::set1(1.f));
+		simd::store(out + i, simd::select(simd::greater(simd::load(clamp + i), simd::set1(0.5f)), clamped, v));
+	}
 }
@@ -22,24 +22,132 @@ MixNode::MixNode(const std::string_view &type) : Node {type, CATEGORY_MATH}
 	AddModuleDependency("mix");
 }
 
-std::string MixNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void MixNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = ";
-	auto c1 = gn.GetInputNameOrValue(IN_COLOR1);
-	auto c2 = gn.GetInputNameOrValue(IN_COLOR2);
-	auto fac = gn.GetInputNameOrValue(IN_FAC);
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = ";
+	glsl::InputNameOrValue c1 {gn, IN_COLOR1};
+	glsl::InputNameOrValue c2 {gn, IN_COLOR2};
+	glsl::InputNameOrValue fac {gn, IN_FAC};
 	auto type = *gn.GetConstantInputValue<Type>(IN_TYPE);
 	std::string opName {magic_enum::enum_name(type)};
 	opName = string::to_snake_case(opName);
 	opName += "_color";
 	code << opName << "(" << c1 << ", " << c2 << ", " << fac << ");\n";
 
-	auto clamp = gn.GetInputNameOrValue(IN_CLAMP);
+	glsl::InputNameOrValue clamp {gn, IN_CLAMP};
 	auto constClamp = gn.GetConstantInputValue<bool>(IN_CLAMP);
 	if(!constClamp.has_value() || *constClamp) {
-		auto outVarName = gn.GetOutputVarName(OUT_COLOR);
+		glsl::OutputVarName outVarName {gn, OUT_COLOR};
 		code << outVarName << " = " << clamp << " ? clamp(" << outVarName << ", 0.0, 1.0) : " << outVarName << ";\n";
 	}
-	return code.str();
+}
+
+uint32_t MixNode::GetKernelVariant(const GraphNode &gn) const { return math::to_integral(*gn.GetConstantInputValue<Type>(IN_TYPE)); }
+
+static Vector3 mix_color(MixNode::Type type, const Vector3 &c1, const Vector3 &c2, float t)
+{
+	auto tm = 1.f - t;
+	switch(type) {
+	case MixNode::Type::Mix:
+		return kernel::mix(c1, c2, t);
+	case MixNode::Type::Add:
+		return kernel::mix(c1, c1 + c2, t);
+	case MixNode::Type::Multiply:
+		return kernel::mix(c1, c1 * c2, t);
+	case MixNode::Type::Screen:
+		return Vector3 {1.f, 1.f, 1.f} - (Vector3 {tm, tm, tm} + t * (Vector3 {1.f, 1.f, 1.f} - c2)) * (Vector3 {1.f, 1.f, 1.f} - c1);
+	case MixNode::Type::Overlay:
+		{
+			auto overlay = [t, tm](float a, float b) -> float { return (a < 0.5f) ? a * (tm + 2.f * t * b) : 1.f - (tm + 2.f * t * (1.f - b)) * (1.f - a); };
+			return Vector3 {overlay(c1.x, c2.x), overlay(c1.y, c2.y), overlay(c1.z, c2.z)};
+		}
+	case MixNode::Type::Subtract:
+		return kernel::mix(c1, c1 - c2, t);
+	case MixNode::Type::Divide:
+		{
+			auto divide = [t, tm](float a, float b) -> float { return (b != 0.f) ? tm * a + t * a / b : a; };
+			return Vector3 {divide(c1.x, c2.x), divide(c1.y, c2.y), divide(c1.z, c2.z)};
+		}
+	case MixNode::Type::Difference:
+		return kernel::mix(c1, Vector3 {std::abs(c1.x - c2.x), std::abs(c1.y - c2.y), std::abs(c1.z - c2.z)}, t);
+	case MixNode::Type::Darken:
+		return kernel::mix(c1, Vector3 {std::min(c1.x, c2.x), std::min(c1.y, c2.y), std::min(c1.z, c2.z)}, t);
+	case MixNode::Type::Lighten:
+		return kernel::mix(c1, Vector3 {std::max(c1.x, c2.x), std::max(c1.y, c2.y), std::max(c1.z, c2.z)}, t);
+	case MixNode::Type::Dodge:
+		{
+			auto dodge = [t](float a, float b) -> float {
+				if(a == 0.f)
+					return a;
+				auto tmp = 1.f - t * b;
+				if(tmp <= 0.f)
+					return 1.f;
+				return std::min(a / tmp, 1.f);
+			};
+			return Vector3 {dodge(c1.x, c2.x), dodge(c1.y, c2.y), dodge(c1.z, c2.z)};
+		}
+	case MixNode::Type::Burn:
+		{
+			auto burn = [t, tm](float a, float b) -> float {
+				auto tmp = tm + t * b;
+				if(tmp <= 0.f)
+					return 0.f;
+				return kernel::clamp(1.f - (1.f - a) / tmp, 0.f, 1.f);
+			};
+			return Vector3 {burn(c1.x, c2.x), burn(c1.y, c2.y), burn(c1.z, c2.z)};
+		}
+	case MixNode::Type::Hue:
+		{
+			auto hsv2 = kernel::rgb_to_hsv(c2);
+			if(hsv2.y == 0.f)
+				return c1;
+			auto hsv = kernel::rgb_to_hsv(c1);
+			hsv.x = hsv2.x;
+			return kernel::mix(c1, kernel::hsv_to_rgb(hsv), t);
+		}
+	case MixNode::Type::Saturation:
+		{
+			auto hsv = kernel::rgb_to_hsv(c1);
+			if(hsv.y == 0.f)
+				return c1;
+			auto hsv2 = kernel::rgb_to_hsv(c2);
+			hsv.y = tm * hsv.y + t * hsv2.y;
+			return kernel::hsv_to_rgb(hsv);
+		}
+	case MixNode::Type::Value:
+		{
+			auto hsv = kernel::rgb_to_hsv(c1);
+			auto hsv2 = kernel::rgb_to_hsv(c2);
+			hsv.z = tm * hsv.z + t * hsv2.z;
+			return kernel::hsv_to_rgb(hsv);
+		}
+	case MixNode::Type::Color:
+		{
+			auto hsv2 = kernel::rgb_to_hsv(c2);
+			if(hsv2.y == 0.f)
+				return c1;
+			auto hsv = kernel::rgb_to_hsv(c1);
+			hsv.x = hsv2.x;
+			hsv.y = hsv2.y;
+			return kernel::mix(c1, kernel::hsv_to_rgb(hsv), t);
+		}
+	case MixNode::Type::SoftLight:
+		{
+			auto scr = Vector3 {1.f, 1.f, 1.f} - (Vector3 {1.f, 1.f, 1.f} - c2) * (Vector3 {1.f, 1.f, 1.f} - c1);
+			return tm * c1 + t * ((Vector3 {1.f, 1.f, 1.f} - c1) * c2 * c1 + c1 * scr);
+		}
+	case MixNode::Type::LinearLight:
+		return c1 + t * (2.f * c2 - Vector3 {1.f, 1.f, 1.f});
+	case MixNode::Type::Exclusion:
+		return kernel::max(kernel::mix(c1, c1 + c2 - 2.f * c1 * c2, t), 0.f);
+	}
+	return c1;
+}
+
+void MixNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto color = mix_color(args.GetVariant<Type>(), args.GetVector3(IN_COLOR1.index), args.GetVector3(IN_COLOR2.index), args.GetFloat(IN_FAC.index));
+	if(args.GetBool(IN_CLAMP.index))
+		color = kernel::clamp(color, 0.f, 1.f);
+	args.SetVector3(OUT_COLOR.index, color);
 }
@@ -16,12 +16,12 @@ RgbToBwNode::RgbToBwNode(const std::string_view &type) : Node {type, CATEGORY_CO
 	AddOutput(OUT_VAL, DataType::Float);
 }
 
-std::string RgbToBwNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void RgbToBwNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
+	glsl::InputNameOrValue color {gn, IN_COLOR};
 
-	code << gn.GetGlslOutputDeclaration(OUT_VAL) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_VAL} << " = ";
 	code << "dot(" << color << ", vec3(0.2126729f, 0.7151522f, 0.0721750f));\n"; // BT.709 Standard
-	return code.str();
 }
+
+void RgbToBwNode::DoEvaluateKernel(const KernelArgs &args) const { args.SetFloat(OUT_VAL.index, kernel::dot(args.GetVector3(IN_COLOR.index), Vector3 {0.2126729f, 0.7151522f, 0.0721750f})); }
@@ -20,15 +20,21 @@ SeparateHsv::SeparateHsv(const std::string_view &type) : Node {type, CATEGORY_CO
 	AddModuleDependency("color");
 }
 
-std::string SeparateHsv::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void SeparateHsv::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
+	glsl::InputNameOrValue color {gn, IN_COLOR};
 
-	auto hsv = gn.GetVarName("hsv");
+	glsl::VarName hsv {gn, "hsv"};
 	code << "vec3 " << hsv << " = rgb_to_hsv(" << color << ");\n";
-	code << gn.GetGlslOutputDeclaration(OUT_H) << " = " << hsv << ".x;\n";
-	code << gn.GetGlslOutputDeclaration(OUT_S) << " = " << hsv << ".y;\n";
-	code << gn.GetGlslOutputDeclaration(OUT_V) << " = " << hsv << ".z;\n";
-	return code.str();
+	code << glsl::OutputDeclaration {gn, OUT_H} << " = " << hsv << ".x;\n";
+	code << glsl::OutputDeclaration {gn, OUT_S} << " = " << hsv << ".y;\n";
+	code << glsl::OutputDeclaration {gn, OUT_V} << " = " << hsv << ".z;\n";
+}
+
+void SeparateHsv::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto hsv = kernel::rgb_to_hsv(args.GetVector3(IN_COLOR.index));
+	args.SetFloat(OUT_H.index, hsv.x);
+	args.SetFloat(OUT_S.index, hsv.y);
+	args.SetFloat(OUT_V.index, hsv.z);
 }
@@ -18,18 +18,24 @@ SeparateXyzNode::SeparateXyzNode(const std::string_view &type) : Node {type, CAT
 	AddOutput(OUT_Z, DataType::Float);
 }
 
-std::string SeparateXyzNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void SeparateXyzNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto inVector = gn.GetInputNameOrValue(IN_VECTOR);
+	glsl::InputNameOrValue inVector {gn, IN_VECTOR};
 
-	code << gn.GetGlslOutputDeclaration(OUT_X) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_X} << " = ";
 	code << inVector << ".x;\n";
 
-	code << gn.GetGlslOutputDeclaration(OUT_Y) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_Y} << " = ";
 	code << inVector << ".y;\n";
 
-	code << gn.GetGlslOutputDeclaration(OUT_Z) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_Z} << " = ";
 	code << inVector << ".z;\n";
-	return code.str();
+}
+
+void SeparateXyzNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto v = args.GetVector3(IN_VECTOR.index);
+	args.SetFloat(OUT_X.index, v.x);
+	args.SetFloat(OUT_Y.index, v.y);
+	args.SetFloat(OUT_Z.index, v.z);
 }
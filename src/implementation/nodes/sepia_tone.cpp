@@ -16,19 +16,28 @@ SepiaToneNode::SepiaToneNode(const std::string_view &type) : Node {type, CATEGOR
 	AddOutput(OUT_COLOR, DataType::Color);
 }
 
-std::string SepiaToneNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void SepiaToneNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto color = gn.GetInputNameOrValue(IN_COLOR);
+	glsl::InputNameOrValue color {gn, IN_COLOR};
 
-	auto prefix = gn.GetBaseVarName() + "_";
-	auto gray = prefix + "gray";
+	glsl::VarName gray {gn, "gray"};
 	code << "float " << gray << " = dot(" << color << ", vec3(0.3, 0.59, 0.11));\n";
-	code << gn.GetGlslOutputDeclaration(OUT_COLOR) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_COLOR} << " = ";
 	code << "vec3(\n";
 	code << "\tmin(" << gray << " *0.393 + " << color << ".g *0.769 + " << color << ".b *0.189, 1.0),\n";
 	code << "\tmin(" << gray << " *0.349 + " << color << ".g *0.686 + " << color << ".b *0.168, 1.0),\n";
 	code << "\tmin(" << gray << " *0.272 + " << color << ".g *0.534 + " << color << ".b *0.131, 1.0)\n";
 	code << ");\n";
-	return code.str();
+}
+
+void SepiaToneNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto color = args.GetVector3(IN_COLOR.index);
+	auto gray = kernel::dot(color, Vector3 {0.3f, 0.59f, 0.11f});
+	args.SetVector3(OUT_COLOR.index,
+	  Vector3 {
+	    std::min(gray * 0.393f + color.y * 0.769f + color.z * 0.189f, 1.f),
+	    std::min(gray * 0.349f + color.y * 0.686f + color.z * 0.168f, 1.f),
+	    std::min(gray * 0.272f + color.y * 0.534f + color.z * 0.131f, 1.f),
+	  });
 }
@@ -16,12 +16,12 @@ ValueNode::ValueNode(const std::string_view &type) : Node {type, CATEGORY_MATH}
 	AddOutput(OUT_VALUE, DataType::Float);
 }
 
-std::string ValueNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void ValueNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto inValue = gn.GetConstantValue(CONST_VALUE);
+	glsl::ConstantValue inValue {gn, CONST_VALUE};
 
-	code << gn.GetGlslOutputDeclaration(OUT_VALUE) << " = ";
+	code << glsl::OutputDeclaration {gn, OUT_VALUE} << " = ";
 	code << inValue << ";\n";
-	return code.str();
 }
+
+void ValueNode::DoEvaluateKernel(const KernelArgs &args) const { args.SetFloat(OUT_VALUE.index, args.GetFloat(CONST_VALUE.index)); }
@@ -22,29 +22,28 @@ VectorMathNode::VectorMathNode(const std::string_view &type) : Node {type, CATEG
 	AddModuleDependency("math");
 }
 
-static const char *get_output_name(VectorMathNode::Operation op)
+static uint32_t get_output_index(VectorMathNode::Operation op)
 {
 	switch(op) {
 	case VectorMathNode::Operation::DotProduct:
 	case VectorMathNode::Operation::Distance:
 	case VectorMathNode::Operation::Length:
-		return VectorMathNode::OUT_VALUE;
+		return VectorMathNode::OUT_VALUE.index;
 	}
-	return VectorMathNode::OUT_VECTOR;
+	return VectorMathNode::OUT_VECTOR.index;
 }
 
-std::string VectorMathNode::DoEvaluate(const Graph &graph, const GraphNode &gn) const
+void VectorMathNode::DoEvaluate(const Graph &graph, const GraphNode &gn, CodeWriter &code) const
 {
-	std::ostringstream code;
-	auto v1 = gn.GetInputNameOrValue(IN_VECTOR1);
-	auto v2 = gn.GetInputNameOrValue(IN_VECTOR2);
-	auto v3 = gn.GetInputNameOrValue(IN_VECTOR3);
+	glsl::InputNameOrValue v1 {gn, IN_VECTOR1};
+	glsl::InputNameOrValue v2 {gn, IN_VECTOR2};
+	glsl::InputNameOrValue v3 {gn, IN_VECTOR3};
 	auto op = *gn.GetConstantInputValue<Operation>(IN_OPERATION);
 
-	code << gn.GetGlslOutputDeclaration(OUT_VALUE) << " = 0.0;\n";
-	code << gn.GetGlslOutputDeclaration(OUT_VECTOR) << " = vec3(0.0, 0.0, 0.0);\n";
+	code << glsl::OutputDeclaration {gn, OUT_VALUE} << " = 0.0;\n";
+	code << glsl::OutputDeclaration {gn, OUT_VECTOR} << " = vec3(0.0, 0.0, 0.0);\n";
 
-	code << gn.GetOutputVarName(get_output_name(op)) << " = ";
+	code << glsl::OutputVarName {gn, get_output_index(op)} << " = ";
 	switch(op) {
 	case Operation::Add:
 		code << v1 << " +" << v2;
@@ -131,6 +130,239 @@ std::string VectorMathNode::DoEvaluate(const Graph &graph, const GraphNode &gn)
 		throw std::runtime_error("Unknown operation in VectorMathNode::DoEvaluate");
 	}
 	code << ";\n";
+}
+
+uint32_t VectorMathNode::GetKernelVariant(const GraphNode &gn) const { return math::to_integral(*gn.GetConstantInputValue<Operation>(IN_OPERATION)); }
+
+static Vector3 apply_componentwise(const Vector3 &a, const Vector3 &b, float (*f)(float, float)) { return Vector3 {f(a.x, b.x), f(a.y, b.y), f(a.z, b.z)}; }
+static Vector3 apply_componentwise(const Vector3 &a, float (*f)(float)) { return Vector3 {f(a.x), f(a.y), f(a.z)}; }
+
+void VectorMathNode::DoEvaluateKernel(const KernelArgs &args) const
+{
+	auto v1 = args.GetVector3(IN_VECTOR1.index);
+	auto v2 = args.GetVector3(IN_VECTOR2.index);
+	auto v3 = args.GetVector3(IN_VECTOR3.index);
+	auto value = 0.f;
+	Vector3 vector {0.f, 0.f, 0.f};
+	switch(args.GetVariant<Operation>()) {
+	case Operation::Add:
+		vector = v1 + v2;
+		break;
+	case Operation::Subtract:
+		vector = v1 - v2;
+		break;
+	case Operation::Multiply:
+	case Operation::Scale:
+		vector = v1 * v2;
+		break;
+	case Operation::Divide:
+		vector = v1 / v2;
+		break;
+	case Operation::CrossProduct:
+		vector = kernel::cross(v1, v2);
+		break;
+	case Operation::DotProduct:
+		value = kernel::dot(v1, v2);
+		break;
+	case Operation::Distance:
+		value = kernel::length(v1 - v2);
+		break;
+	case Operation::Length:
+		value = kernel::length(v1);
+		break;
+	case Operation::Normalize:
+		vector = kernel::normalize(v1);
+		break;
+	case Operation::Reflect:
+		vector = v1 - 2.f * kernel::dot(v2, v1) * v2;
+		break;
+	case Operation::Project:
+		{
+			auto lenSqr = kernel::dot(v2, v2);
+			vector = (lenSqr != 0.f) ? v2 * (kernel::dot(v1, v2) / lenSqr) : Vector3 {0.f, 0.f, 0.f};
+			break;
+		}
+	case Operation::Snap:
+		vector = apply_componentwise(v1 / v2, [](float x) -> float { return std::floor(x); }) * v2;
+		break;
+	case Operation::Floor:
+		vector = apply_componentwise(v1, [](float x) -> float { return std::floor(x); });
+		break;
+	case Operation::Ceil:
+		vector = apply_componentwise(v1, [](float x) -> float { return std::ceil(x); });
+		break;
+	case Operation::Modulo:
+		vector = apply_componentwise(v1, v2, kernel::mod);
+		break;
+	case Operation::Fraction:
+		vector = apply_componentwise(v1, kernel::fract);
+		break;
+	case Operation::Absolute:
+		vector = apply_componentwise(v1, [](float x) -> float { return std::abs(x); });
+		break;
+	case Operation::Minimum:
+		vector = apply_componentwise(v1, v2, [](float a, float b) -> float { return std::min(a, b); });
+		break;
+	case Operation::Maximum:
+		vector = apply_componentwise(v1, v2, [](float a, float b) -> float { return std::max(a, b); });
+		break;
+	case Operation::Wrap:
+		vector = Vector3 {kernel::wrap(v1.x, v2.x, v3.x), kernel::wrap(v1.y, v2.y, v3.y), kernel::wrap(v1.z, v2.z, v3.z)};
+		break;
+	case Operation::Sine:
+		vector = apply_componentwise(v1, [](float x) -> float { return std::sin(x); });
+		break;
+	case Operation::Cosine:
+		vector = apply_componentwise(v1, [](float x) -> float { return std::cos(x); });
+		break;
+	case Operation::Tangent:
+		vector = apply_componentwise(v1, [](float x) -> float { return std::tan(x); });
+		break;
+	case Operation::Refract:
+		{
+			// Same as GLSL's refract, with the first component of the third vector as the ratio of indices of refraction
+			auto eta = v3.x;
+			auto d = kernel::dot(v2, v1);
+			auto k = 1.f - eta * eta * (1.f - d * d);
+			vector = (k < 0.f) ? Vector3 {0.f, 0.f, 0.f} : eta * v1 - (eta * d + std::sqrt(k)) * v2;
+			break;
+		}
+	case Operation::FaceForward:
+		vector = (kernel::dot(v3, v2) < 0.f) ? v1 : -v1;
+		break;
+	case Operation::MultiplyAdd:
+		vector = v1 * v2 + v3;
+		break;
+	default:
+		throw std::runtime_error("Unknown operation in VectorMathNode::DoEvaluateKernel");
+	}
+	args.SetFloat(OUT_VALUE.index, value);
+	args.SetVector3(OUT_VECTOR.index, vector);
+}
+
+void VectorMathNode::DoEvaluateKernelBatch(const BatchKernelArgs &args) const
+{
+	namespace simd = kernel::simd;
+	using Vec = std::array<simd::Float, 3>;
+	auto laneCount = args.GetLaneCount();
+	std::array<const float *, 3> v1, v2, v3;
+	std::array<float *, 3> outVector;
+	for(uint32_t i = 0; i < 3; ++i) {
+		v1[i] = args.GetInputStream(IN_VECTOR1.index, i);
+		v2[i] = args.GetInputStream(IN_VECTOR2.index, i);
+		v3[i] = args.GetInputStream(IN_VECTOR3.index, i);
+		outVector[i] = args.GetOutputStream(OUT_VECTOR.index, i);
+	}
+	auto *outValue = args.GetOutputStream(OUT_VALUE.index);
+	auto load = [](const std::array<const float *, 3> &streams, uint32_t i) -> Vec { return Vec {simd::load(streams[0] + i), simd::load(streams[1] + i), simd::load(streams[2] + i)}; };
+	auto dot = [](const Vec &a, const Vec &b) { return simd::add(simd::add(simd::mul(a[0], b[0]), simd::mul(a[1], b[1])), simd::mul(a[2], b[2])); };
+	auto clear = [laneCount](float *stream) { std::fill(stream, stream + laneCount, 0.f); };
 
-	return code.str();
+	// Operations that are applied to each component stream independently
+	auto componentwise = [&](auto op) {
+		for(uint32_t c = 0; c < 3; ++c) {
+			for(uint32_t i = 0; i < laneCount; i += simd::WIDTH)
+				simd::store(outVector[c] + i, op(simd::load(v1[c] + i), simd::load(v2[c] + i), simd::load(v3[c] + i)));
+		}
+		clear(outValue);
+	};
+	auto valueOutput = [&](auto op) {
+		for(uint32_t i = 0; i < laneCount; i += simd::WIDTH)
+			simd::store(outValue + i, op(load(v1, i), load(v2, i)));
+		for(auto *stream : outVector)
+			clear(stream);
+	};
+	auto vectorOutput = [&](auto op) {
+		for(uint32_t i = 0; i < laneCount; i += simd::WIDTH) {
+			auto result = op(load(v1, i), load(v2, i));
+			for(uint32_t c = 0; c < 3; ++c)
+				simd::store(outVector[c] + i, result[c]);
+		}
+		clear(outValue);
+	};
+	switch(args.GetVariant<Operation>()) {
+	case Operation::Add:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::add(a, b); });
+		break;
+	case Operation::Subtract:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::sub(a, b); });
+		break;
+	case Operation::Multiply:
+	case Operation::Scale:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::mul(a, b); });
+		break;
+	case Operation::Divide:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::div(a, b); });
+		break;
+	case Operation::MultiplyAdd:
+		componentwise([](simd::Float a, simd::Float b, simd::Float c) { return simd::add(simd::mul(a, b), c); });
+		break;
+	case Operation::Minimum:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::min(a, b); });
+		break;
+	case Operation::Maximum:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::max(a, b); });
+		break;
+	case Operation::Absolute:
+		componentwise([](simd::Float a, simd::Float, simd::Float) { return simd::abs(a); });
+		break;
+	case Operation::Floor:
+		componentwise([](simd::Float a, simd::Float, simd::Float) { return simd::floor(a); });
+		break;
+	case Operation::Ceil:
+		componentwise([](simd::Float a, simd::Float, simd::Float) { return simd::ceil(a); });
+		break;
+	case Operation::Fraction:
+		componentwise([](simd::Float a, simd::Float, simd::Float) { return simd::fract(a); });
+		break;
+	case Operation::Modulo:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::mod(a, b); });
+		break;
+	case Operation::Snap:
+		componentwise([](simd::Float a, simd::Float b, simd::Float) { return simd::mul(simd::floor(simd::div(a, b)), b); });
+		break;
+	case Operation::DotProduct:
+		valueOutput([&dot](const Vec &a, const Vec &b) { return dot(a, b); });
+		break;
+	case Operation::Length:
+		valueOutput([&dot](const Vec &a, const Vec &) { return simd::sqrt(dot(a, a)); });
+		break;
+	case Operation::Distance:
+		valueOutput([&dot](const Vec &a, const Vec &b) {
+			Vec d {simd::sub(a[0], b[0]), simd::sub(a[1], b[1]), simd::sub(a[2], b[2])};
+			return simd::sqrt(dot(d, d));
+		});
+		break;
+	case Operation::CrossProduct:
+		vectorOutput([](const Vec &a, const Vec &b) {
+			return Vec {simd::sub(simd::mul(a[1], b[2]), simd::mul(a[2], b[1])), simd::sub(simd::mul(a[2], b[0]), simd::mul(a[0], b[2])), simd::sub(simd::mul(a[0], b[1]), simd::mul(a[1], b[0]))};
+		});
+		break;
+	case Operation::Normalize:
+		vectorOutput([&dot](const Vec &a, const Vec &) {
+			auto l = simd::sqrt(dot(a, a));
+			auto valid = simd::not_equal(l, simd::set1(0.f));
+			auto inv = simd::div(simd::set1(1.f), l);
+			return Vec {simd::select(valid, simd::mul(a[0], inv), simd::set1(0.f)), simd::select(valid, simd::mul(a[1], inv), simd::set1(0.f)), simd::select(valid, simd::mul(a[2], inv), simd::set1(0.f))};
+		});
+		break;
+	case Operation::Project:
+		vectorOutput([&dot](const Vec &a, const Vec &b) {
+			auto lenSqr = dot(b, b);
+			auto valid = simd::not_equal(lenSqr, simd::set1(0.f));
+			auto f = simd::div(dot(a, b), lenSqr);
+			return Vec {simd::select(valid, simd::mul(b[0], f), simd::set1(0.f)), simd::select(valid, simd::mul(b[1], f), simd::set1(0.f)), simd::select(valid, simd::mul(b[2], f), simd::set1(0.f))};
+		});
+		break;
+	case Operation::Reflect:
+		vectorOutput([&dot](const Vec &a, const Vec &b) {
+			auto f = simd::mul(simd::set1(2.f), dot(b, a));
+			return Vec {simd::sub(a[0], simd::mul(f, b[0])), simd::sub(a[1], simd::mul(f, b[1])), simd::sub(a[2], simd::mul(f, b[2]))};
+		});
+		break;
+	default:
+		// No vectorized implementation, fall back to the scalar kernel
+		Node::DoEvaluateKernelBatch(args);
+		break;
+	}
 }
@@ -18,43 +18,71 @@ Value::~Value() { Clear(); }
 
 Value &Value::operator=(const Value &other)
 {
+	if(this == &other)
+		return *this;
 	Clear();
 	m_type = other.m_type;
 	if(!other)
 		return *this;
-	visit(m_type, [this, &other](auto tag) {
-		using T = typename decltype(tag)::type;
-		T val;
-		auto res = other.Get<T>(val);
-		assert(res);
-		Set<T>(val);
-	});
+	if(m_type == DataType::String)
+		m_string = new udm::String {*other.m_string};
+	else
+		m_storage = other.m_storage;
+	m_hasValue = true;
 	return *this;
 }
 Value &Value::operator=(Value &&other)
 {
+	if(this == &other)
+		return *this;
 	Clear();
 	m_type = other.m_type;
 	if(!other)
 		return *this;
-	m_value = other.m_value;
-	other.m_value = nullptr;
+	if(m_type == DataType::String) {
+		m_string = other.m_string;
+		other.m_string = nullptr;
+		other.m_hasValue = false;
+	}
+	else
+		m_storage = other.m_storage;
+	m_hasValue = true;
 	return *this;
 }
 
 void Value::Clear()
 {
-	if(!m_value)
+	if(!m_hasValue)
 		return;
-	visit(m_type, [this](auto tag) {
+	if(m_type == DataType::String)
+		delete m_string;
+	m_hasValue = false;
+}
+
+const udm::DataValue Value::GetData() const
+{
+	if(!m_hasValue)
+		return nullptr;
+	if(m_type == DataType::String)
+		return m_string;
+	return const_cast<std::byte *>(m_storage.data());
+}
+Value::operator bool() const { return m_hasValue; }
+hash::Hash Value::GetHash() const
+{
+	if(!m_hasValue)
+		return 0;
+	return visit(m_type, [this](auto tag) -> hash::Hash {
 		using T = typename decltype(tag)::type;
-		delete static_cast<T *>(m_value);
+		if constexpr(std::is_same_v<T, udm::String>)
+			return hash::hash_string(*m_string);
+		else if constexpr(std::is_same_v<T, udm::Half>)
+			return hash::hash_value(static_cast<float>(*GetInlineValue<T>()));
+		else
+			return hash::hash_value(*GetInlineValue<T>());
 	});
-	m_value = nullptr;
 }
 
-Value::operator bool() const { return m_value != nullptr; }
-
 Parameter::Parameter(const std::string &name, DataType type) : name(name), type(type), defaultValue {type} {}
 
 Parameter::Parameter(const Parameter &other) : Parameter {other.name, other.type}
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+module pragma.shadergraph;
+
+import :thread_pool;
+
+using namespace pragma::shadergraph;
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+	if(threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	m_queues.reserve(threadCount);
+	for(uint32_t i = 0; i < threadCount; ++i)
+		m_queues.push_back(std::make_unique<Queue>());
+	m_threads.reserve(threadCount);
+	for(uint32_t i = 0; i < threadCount; ++i)
+		m_threads.emplace_back([this, i]() { Run(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::scoped_lock lock {m_mutex};
+		m_stop = true;
+	}
+	m_taskAvailable.notify_all();
+	for(auto &thread : m_threads)
+		thread.join();
+}
+
+void ThreadPool::Submit(Task task)
+{
+	auto &queue = *m_queues[m_nextQueue++ % m_queues.size()];
+	{
+		// The task is pushed while the counters are locked, so a worker can't take it before it has been counted
+		std::scoped_lock lock {m_mutex};
+		{
+			std::scoped_lock queueLock {queue.mutex};
+			queue.tasks.push_back(std::move(task));
+		}
+		++m_numQueued;
+		++m_numPending;
+	}
+	m_taskAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock lock {m_mutex};
+	m_tasksDone.wait(lock, [this]() { return m_numPending == 0; });
+}
+
+bool ThreadPool::TryPop(uint32_t threadIdx, Task &outTask)
+{
+	auto pop = [&outTask](Queue &queue, bool back) {
+		std::scoped_lock lock {queue.mutex};
+		if(queue.tasks.empty())
+			return false;
+		if(back) {
+			outTask = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else {
+			outTask = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		return true;
+	};
+	auto numQueues = m_queues.size();
+	auto found = pop(*m_queues[threadIdx], true);
+	for(size_t i = 1; !found && i < numQueues; ++i)
+		found = pop(*m_queues[(threadIdx + i) % numQueues], false);
+	if(!found)
+		return false;
+	std::scoped_lock lock {m_mutex};
+	--m_numQueued;
+	return true;
+}
+
+void ThreadPool::Run(uint32_t threadIdx)
+{
+	for(;;) {
+		Task task;
+		if(TryPop(threadIdx, task)) {
+			task(threadIdx);
+			task = nullptr;
+			std::scoped_lock lock {m_mutex};
+			if(--m_numPending == 0)
+				m_tasksDone.notify_all();
+			continue;
+		}
+		std::unique_lock lock {m_mutex};
+		m_taskAvailable.wait(lock, [this]() { return m_stop || m_numQueued > 0; });
+		// Remaining tasks are finished before the worker exits
+		if(m_numQueued == 0)
+			return;
+	}
+}
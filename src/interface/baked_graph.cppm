@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+export module pragma.shadergraph:baked_graph;
+
+import :bytecode;
+import :hash;
+import :node_registry;
+
+export namespace pragma::shadergraph {
+	class Graph;
+	// Flat, position-independent representation of a resolved graph for shipping builds. It is baked offline from a graph (see Bake)
+	// and memory-mapped at runtime (see Open), so neither parsing nor the construction of graph nodes is required.
+	// All references within the file are indices or byte offsets relative to the start of the file. It contains:
+	// - The generated GLSL code
+	// - If all nodes have CPU kernels, the bytecode program: one entry per node in topological order, the operand registers of the nodes
+	//   (which replace the links), the initial register values (the constant inputs) and the bindings of the unlinked inputs and outputs
+	// - The interned strings referenced by the above
+	class BakedGraph {
+	  public:
+		static constexpr auto EXTENSION = "psg_baked";
+		static constexpr std::array<char, 4> IDENTIFIER {'P', 'S', 'G', 'K'};
+		static constexpr uint32_t VERSION = 1;
+
+		// Compares loading a binary graph file and compiling it with opening a baked graph and creating the program from it
+		static void Benchmark(uint32_t nodeCount = 10'000, uint32_t iterations = 10);
+
+		// Byte offset of the first element and number of elements of a section
+		struct Range {
+			uint32_t offset = 0;
+			uint32_t count = 0;
+		};
+		struct StringEntry {
+			uint32_t offset = 0;
+			uint32_t length = 0;
+		};
+		struct NodeEntry {
+			// String index of the node type
+			uint32_t type = 0;
+			uint32_t variant = 0;
+			// See BytecodeInstruction
+			uint32_t firstOperand = 0;
+			uint32_t numInputs = 0;
+			uint32_t numOutputs = 0;
+		};
+		struct BindingEntry {
+			// String indices
+			uint32_t nodeName = 0;
+			uint32_t socketName = 0;
+			uint32_t type = 0;
+			Register reg = INVALID_REGISTER;
+		};
+		enum class Flags : uint32_t {
+			None = 0u,
+			HasBytecode = 1u,
+		};
+		struct Header {
+			std::array<char, 4> identifier {};
+			uint32_t version = 0;
+			// Fingerprint of the node registry the graph was baked with (see NodeRegistry::GetFingerprint)
+			hash::Hash registryFingerprint = 0;
+			Flags flags = Flags::None;
+			// String indices
+			uint32_t glslHeader = 0;
+			uint32_t glslBody = 0;
+			Range strings;
+			Range characters;
+			Range nodes;
+			Range operands;
+			Range initialRegisters;
+			Range inputs;
+			Range outputs;
+		};
+
+		static bool Bake(const Graph &graph, std::vector<std::byte> &outData, std::string &outErr);
+		static bool Bake(const Graph &graph, const std::string &filePath, std::string &outErr);
+		// Maps the file into memory. The sections are validated, but not copied.
+		static std::unique_ptr<BakedGraph> Open(const std::string &filePath, std::string &outErr);
+		// The memory must outlive the baked graph and must be aligned to at least 8 bytes
+		static std::unique_ptr<BakedGraph> FromMemory(std::span<const std::byte> data, std::string &outErr);
+
+		BakedGraph(const BakedGraph &) = delete;
+		BakedGraph &operator=(const BakedGraph &) = delete;
+		~BakedGraph();
+
+		const Header &GetHeader() const { return *reinterpret_cast<const Header *>(m_data.data()); }
+		std::string_view GetString(uint32_t idx) const;
+		std::string_view GetGlslHeader() const { return GetString(GetHeader().glslHeader); }
+		std::string_view GetGlslBody() const { return GetString(GetHeader().glslBody); }
+		bool HasBytecode() const { return (math::to_integral(GetHeader().flags) & math::to_integral(Flags::HasBytecode)) != 0; }
+		std::span<const NodeEntry> GetNodes() const { return GetSection<NodeEntry>(GetHeader().nodes); }
+		std::span<const Register> GetOperands() const { return GetSection<Register>(GetHeader().operands); }
+		std::span<const float> GetInitialRegisters() const { return GetSection<float>(GetHeader().initialRegisters); }
+		std::span<const BindingEntry> GetInputs() const { return GetSection<BindingEntry>(GetHeader().inputs); }
+		std::span<const BindingEntry> GetOutputs() const { return GetSection<BindingEntry>(GetHeader().outputs); }
+
+		// Creates a program for the interpreters. The sections are copied as they are, only the node types have to be looked up.
+		// Fails if the registry differs from the one the graph was baked with.
+		bool CreateProgram(const NodeRegistry &reg, BytecodeProgram &outProgram, std::string &outErr) const;
+	  private:
+		BakedGraph() = default;
+		bool Validate(std::string &outErr) const;
+		template<typename T>
+		std::span<const T> GetSection(const Range &range) const
+		{
+			return {reinterpret_cast<const T *>(m_data.data() + range.offset), range.count};
+		}
+		std::span<const std::byte> m_data;
+		// Only set if the data was mapped by Open
+		void *m_mapping = nullptr;
+		size_t m_mappingSize = 0;
+	};
+};
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+export module pragma.shadergraph:batch_compiler;
+
+import :glsl_cache;
+import :graph;
+import :node_registry;
+import :thread_pool;
+
+export namespace pragma::shadergraph {
+	// Generates the GLSL code of many graphs in parallel. The items of a batch are distributed over a work-stealing thread pool,
+	// which is kept alive between batches. All graphs share the node registry, which is safe as long as no node types
+	// are registered during a batch (see NodeRegistry).
+	class BatchCompiler {
+	  public:
+		struct Item {
+			// Graph to compile. If it is nullptr, the graph is loaded from filePath instead.
+			// The graph must not be modified during the batch. It may be part of the batch more than once, in which case
+			// its items are compiled one after another (see Graph::GenerateGlsl).
+			const Graph *graph = nullptr;
+			std::string filePath;
+			std::optional<std::string> namePrefix {};
+		};
+		struct Result {
+			size_t itemIndex = 0;
+			bool success = false;
+			std::string error;
+			std::string glslHeader;
+			std::string glslBody;
+			// Index of the worker thread that compiled the item
+			uint32_t threadIndex = 0;
+			std::chrono::nanoseconds loadTime {};
+			std::chrono::nanoseconds compileTime {};
+		};
+		struct Statistics {
+			size_t numSucceeded = 0;
+			size_t numFailed = 0;
+			uint32_t threadCount = 0;
+			std::chrono::nanoseconds wallTime {};
+			// Sum and maximum of the load and compile times of the individual items
+			std::chrono::nanoseconds totalItemTime {};
+			std::chrono::nanoseconds maxItemTime {};
+			double GetItemsPerSecond() const;
+		};
+		// Called once for every item as soon as it has been compiled, i.e. in order of completion rather than in order of the items.
+		// Calls may happen on any worker thread, but never concurrently. The callback must not throw.
+		using ResultCallback = std::function<void(Result &&)>;
+
+		// Compiles the same graphs serially and in parallel with a shared registry and verifies that the results are identical
+		static void Test();
+		// Compares the throughput of a single worker thread with the throughput of all hardware threads
+		static void Benchmark(uint32_t graphCount = 1'000, uint32_t nodeCount = 200);
+
+		// If threadCount is 0, the number of hardware threads is used
+		BatchCompiler(const std::shared_ptr<NodeRegistry> &reg, uint32_t threadCount = 0);
+		BatchCompiler(const BatchCompiler &) = delete;
+		BatchCompiler &operator=(const BatchCompiler &) = delete;
+
+		uint32_t GetThreadCount() const { return m_threadPool.GetThreadCount(); }
+		// If set, the code is looked up in or added to the cache instead of being generated every time
+		void SetGlslCache(GlslCache *cache) { m_glslCache = cache; }
+		GlslCache *GetGlslCache() const { return m_glslCache; }
+
+		// Blocks until all items have been compiled. Items that fail are reported through the callback with the error message,
+		// the remaining items are compiled regardless.
+		Statistics CompileBatch(std::span<const Item> items, const ResultCallback &callback);
+	  private:
+		void Compile(const Item &item, Result &outResult) const;
+
+		std::shared_ptr<NodeRegistry> m_nodeRegistry;
+		GlslCache *m_glslCache = nullptr;
+		ThreadPool m_threadPool;
+	};
+};
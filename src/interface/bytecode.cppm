@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+
+export module pragma.shadergraph:bytecode;
+
+import :kernel;
+import :node;
+
+export namespace pragma::shadergraph {
+	class Graph;
+	class BakedGraph;
+	struct BytecodeInstruction {
+		const Node *node = nullptr;
+		uint32_t variant = 0;
+		// Operands [firstOperand, firstOperand +numInputs) are the input registers of the node,
+		// followed by one register per output.
+		uint32_t firstOperand = 0;
+		uint32_t numInputs = 0;
+	};
+
+	// Register-based program lowered from a resolved graph by Graph::CompileBytecode.
+	class BytecodeProgram {
+	  public:
+		struct SocketBinding {
+			std::string nodeName;
+			std::string socketName;
+			DataType type = DataType::Invalid;
+			Register reg = INVALID_REGISTER;
+		};
+
+		BytecodeProgram() = default;
+		void Clear();
+
+		const std::vector<BytecodeInstruction> &GetInstructions() const { return m_instructions; }
+		const std::vector<Register> &GetOperands() const { return m_operands; }
+		const std::vector<float> &GetInitialRegisters() const { return m_initialRegisters; }
+		uint32_t GetRegisterCount() const { return m_initialRegisters.size(); }
+
+		// Unlinked input sockets, which can be overwritten before executing the program
+		const std::vector<SocketBinding> &GetInputs() const { return m_inputs; }
+		const std::vector<SocketBinding> &GetOutputs() const { return m_outputs; }
+		const SocketBinding *FindInput(const std::string_view &nodeName, const std::string_view &inputName) const;
+		const SocketBinding *FindOutput(const std::string_view &nodeName, const std::string_view &outputName) const;
+	  private:
+		friend Graph;
+		friend BakedGraph;
+		std::vector<BytecodeInstruction> m_instructions;
+		std::vector<Register> m_operands;
+		std::vector<float> m_initialRegisters;
+		std::vector<SocketBinding> m_inputs;
+		std::vector<SocketBinding> m_outputs;
+	};
+
+	// Evaluates a bytecode program on the CPU. The program must outlive the interpreter.
+	class BytecodeInterpreter {
+	  public:
+		BytecodeInterpreter(const BytecodeProgram &program);
+		void Reset();
+		void Execute();
+
+		template<typename T>
+		bool SetInputValue(const std::string_view &nodeName, const std::string_view &inputName, const T &value);
+		template<typename T>
+		bool GetOutputValue(const std::string_view &nodeName, const std::string_view &outputName, T &outVal) const;
+
+		float *GetRegisters() { return m_registers.data(); }
+		const float *GetRegisters() const { return m_registers.data(); }
+		const BytecodeProgram &GetProgram() const { return m_program; }
+	  private:
+		const BytecodeProgram &m_program;
+		std::vector<float> m_registers;
+	};
+
+	// Evaluates a bytecode program for many lanes (e.g. pixels) at once. Registers are stored as structure-of-arrays,
+	// so nodes with batched kernels can process them with SIMD instructions. The program must outlive the interpreter.
+	class BytecodeBatchInterpreter {
+	  public:
+		// Compares the throughput of the scalar and the batched interpreter for a representative graph
+		static void Benchmark(uint32_t width = 1024, uint32_t height = 1024);
+
+		BytecodeBatchInterpreter(const BytecodeProgram &program, uint32_t laneCount);
+		void Reset();
+		void Execute();
+
+		uint32_t GetLaneCount() const { return m_laneCount; }
+		// Returns the stream for one component of an unlinked input, or nullptr if there is no such input
+		float *GetInputStream(const std::string_view &nodeName, const std::string_view &inputName, uint32_t component = 0);
+		const float *GetOutputStream(const std::string_view &nodeName, const std::string_view &outputName, uint32_t component = 0) const;
+		float *GetRegisterStream(Register reg) { return m_registers.data() + reg * m_laneStride; }
+		const float *GetRegisterStream(Register reg) const { return m_registers.data() + reg * m_laneStride; }
+		const BytecodeProgram &GetProgram() const { return m_program; }
+	  private:
+		const BytecodeProgram &m_program;
+		uint32_t m_laneCount;
+		uint32_t m_laneStride;
+		std::vector<float> m_registers;
+	};
+
+	template<typename T>
+	bool BytecodeInterpreter::SetInputValue(const std::string_view &nodeName, const std::string_view &inputName, const T &value)
+	{
+		if constexpr(std::is_enum_v<T>)
+			return SetInputValue(nodeName, inputName, math::to_integral(value));
+		else {
+			auto *binding = m_program.FindInput(nodeName, inputName);
+			if(!binding)
+				return false;
+			return visit(binding->type, [this, binding, &value](auto tag) {
+				using TTo = typename decltype(tag)::type;
+				if constexpr(udm::is_convertible<T, TTo>() && !std::is_same_v<TTo, udm::String> && !std::is_same_v<TTo, udm::Mat4>) {
+					store_registers(m_registers.data() + binding->reg, udm::convert<T, TTo>(value));
+					return true;
+				}
+				return false;
+			});
+		}
+	}
+	template<typename T>
+	bool BytecodeInterpreter::GetOutputValue(const std::string_view &nodeName, const std::string_view &outputName, T &outVal) const
+	{
+		auto *binding = m_program.FindOutput(nodeName, outputName);
+		if(!binding)
+			return false;
+		return visit(binding->type, [this, binding, &outVal](auto tag) {
+			using TFrom = typename decltype(tag)::type;
+			if constexpr(udm::is_convertible<TFrom, T>() && !std::is_same_v<TFrom, udm::String> && !std::is_same_v<TFrom, udm::Mat4>) {
+				outVal = udm::convert<TFrom, T>(load_registers<TFrom>(m_registers.data() + binding->reg));
+				return true;
+			}
+			return false;
+		});
+	}
+};
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+export module pragma.shadergraph:compiled_graph;
+
+import :graph_node;
+import :node;
+
+export namespace pragma::shadergraph {
+	class Graph;
+	// Immutable snapshot of the topology of a graph. Nodes are stored by node index in contiguous arrays, and links are stored
+	// in compressed sparse row (CSR) form, both from the inputs to their producers and from the outputs to their consumers.
+	// Only the input links of the graph are used for construction, so it can also be built from a view (see Graph::Materialize).
+	// The snapshot has to be rebuilt whenever nodes are added or removed, or links are changed.
+	class CompiledGraph {
+	  public:
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+		// Node index and socket index
+		struct SocketRef {
+			uint32_t node = INVALID_INDEX;
+			uint32_t socket = INVALID_INDEX;
+		};
+
+		// Compares traversals on the compiled graph with traversals along the socket pointers of the graph
+		static void Benchmark(uint32_t nodeCount = 10'000, uint32_t iterations = 100);
+
+		CompiledGraph() = default;
+		// O(V +E)
+		CompiledGraph(const Graph &graph);
+		// Same as the constructor, but re-uses the memory of the previous snapshot
+		void Build(const Graph &graph);
+		// Replaces the node at the specified index with a node that has the same links, e.g. a materialized copy (see Graph::Materialize)
+		void UpdateNode(uint32_t nodeIdx, GraphNode &node) { m_nodes[nodeIdx] = &node; }
+
+		uint32_t GetNodeCount() const { return m_nodes.size(); }
+		uint32_t GetLinkCount() const { return m_consumers.size(); }
+		GraphNode &GetNode(uint32_t nodeIdx) const { return *m_nodes[nodeIdx]; }
+		const Node &GetNodeType(uint32_t nodeIdx) const { return m_nodes[nodeIdx]->node; }
+
+		// Producer output of each input of the node, or INVALID_INDEX if the input is not linked
+		std::span<const SocketRef> GetInputLinks(uint32_t nodeIdx) const { return {m_inputLinks.data() + m_inputOffsets[nodeIdx], m_inputLinks.data() + m_inputOffsets[nodeIdx + 1]}; }
+		uint32_t GetOutputCount(uint32_t nodeIdx) const { return m_outputOffsets[nodeIdx + 1] - m_outputOffsets[nodeIdx]; }
+		// Consumer inputs of the output, ordered by node index
+		std::span<const SocketRef> GetConsumers(uint32_t nodeIdx, uint32_t outputIdx) const
+		{
+			auto slot = m_outputOffsets[nodeIdx] + outputIdx;
+			return {m_consumers.data() + m_consumerOffsets[slot], m_consumers.data() + m_consumerOffsets[slot + 1]};
+		}
+		// Consumer inputs of all outputs of the node
+		std::span<const SocketRef> GetConsumers(uint32_t nodeIdx) const
+		{
+			return {m_consumers.data() + m_consumerOffsets[m_outputOffsets[nodeIdx]], m_consumers.data() + m_consumerOffsets[m_outputOffsets[nodeIdx + 1]]};
+		}
+
+		// Marks all nodes that at least one output node depends on, or all nodes if there are no output nodes
+		std::vector<bool> FindLiveNodes() const;
+		// Kahn's algorithm. Nodes without a mutual dependency keep the order of their node indices, so the result is deterministic.
+		// If a mask is specified, only the marked nodes are sorted. Returns false if the graph contains a cycle.
+		bool TopologicalSort(std::vector<uint32_t> &outOrder, const std::vector<bool> *mask = nullptr) const;
+		// Same as above, but uses the specified buffer for the in-degrees, so no memory has to be allocated if it is re-used
+		bool TopologicalSort(std::vector<uint32_t> &outOrder, std::vector<uint32_t> &scratch, const std::vector<bool> *mask = nullptr) const;
+	  private:
+		std::vector<GraphNode *> m_nodes;
+		// Input range of node i is [m_inputOffsets[i], m_inputOffsets[i +1])
+		std::vector<uint32_t> m_inputOffsets;
+		std::vector<SocketRef> m_inputLinks;
+		// Output range of node i is [m_outputOffsets[i], m_outputOffsets[i +1]), consumers of output slot j are
+		// [m_consumerOffsets[j], m_consumerOffsets[j +1])
+		std::vector<uint32_t> m_outputOffsets;
+		std::vector<uint32_t> m_consumerOffsets;
+		std::vector<SocketRef> m_consumers;
+	};
+};
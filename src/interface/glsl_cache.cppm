@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+export module pragma.shadergraph:glsl_cache;
+
+import :graph;
+import :hash;
+
+export namespace pragma::shadergraph {
+	// Memoizes Graph::GenerateGlsl. Entries are keyed by the layout hash of the graph (see Graph::GetLayoutHash) and the fingerprint
+	// of its node registry, so identical graphs share the same entry, e.g. the same asset loaded multiple times or by multiple processes.
+	// Least recently used entries are evicted once the total size exceeds the byte limit. All methods are thread-safe.
+	// Optionally entries are also persisted in a cache directory, which may be shared between processes.
+	class GlslCache {
+	  public:
+		using Key = hash::Hash;
+		struct Entry {
+			std::string header;
+			std::string body;
+			size_t GetByteSize() const { return sizeof(Entry) + header.size() + body.size(); }
+		};
+		struct Statistics {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+			uint64_t diskHits = 0;
+			uint64_t diskWrites = 0;
+			size_t entryCount = 0;
+			size_t byteSize = 0;
+		};
+		static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+		// Has to be incremented whenever the generated code changes for the same input, e.g. if a node's DoEvaluate implementation is changed
+		static constexpr uint32_t CODE_GENERATOR_VERSION = 6;
+		static constexpr auto CACHE_FILE_EXTENSION = "psg_glsl";
+		static Key ComputeKey(const Graph &graph, const std::optional<std::string> &namePrefix = {});
+
+		GlslCache(size_t maxBytes = DEFAULT_MAX_BYTES);
+		GlslCache(const GlslCache &) = delete;
+		GlslCache &operator=(const GlslCache &) = delete;
+
+		// Writes the cached code for the graph, or generates and caches it if there is no entry yet
+		void GenerateGlsl(const Graph &graph, std::ostream &outHeader, std::ostream &outBody, const std::optional<std::string> &namePrefix = {});
+
+		std::shared_ptr<const Entry> Find(Key key);
+		void Insert(Key key, const std::shared_ptr<const Entry> &entry);
+		bool Erase(Key key);
+		void Clear();
+
+		// Entries are looked up in the directory if they are not in memory, and newly generated entries are written to it.
+		// Files are written atomically, so multiple processes can use the same directory at the same time.
+		void SetCacheDirectory(const std::optional<std::filesystem::path> &path);
+		std::optional<std::filesystem::path> GetCacheDirectory() const;
+
+		void SetMaxBytes(size_t maxBytes);
+		size_t GetMaxBytes() const;
+		Statistics GetStatistics() const;
+		void ResetStatistics();
+	  private:
+		using EntryList = std::list<std::pair<Key, std::shared_ptr<const Entry>>>;
+		void EvictEntries();
+		void EraseEntry(EntryList::iterator it);
+		std::shared_ptr<const Entry> LoadFromDisk(const std::filesystem::path &dir, Key key) const;
+		bool SaveToDisk(const std::filesystem::path &dir, Key key, const Entry &entry) const;
+
+		mutable std::mutex m_mutex;
+		// Most recently used entries are at the front
+		EntryList m_entryList;
+		std::unordered_map<Key, EntryList::iterator> m_keyToEntry;
+		size_t m_maxBytes;
+		std::optional<std::filesystem::path> m_cacheDirectory {};
+		Statistics m_stats {};
+	};
+};
@@ -8,8 +8,20 @@ export module pragma.shadergraph:graph;
 import :node;
 import :node_registry;
 import :graph_node;
+import :compiled_graph;
+import :bytecode;
+import :hash;
 
 export namespace pragma::shadergraph {
+	// Stable reference to a node of a graph. Unlike node indices, handles are not affected by the removal of other nodes.
+	// Once the node is removed, the handle becomes stale and is never resolved to a different node, even if its slot is re-used.
+	struct NodeHandle {
+		static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+		uint32_t slot = INVALID_SLOT;
+		uint32_t generation = 0;
+		bool operator==(const NodeHandle &) const = default;
+	};
+
 	class Graph {
 	  public:
 		static constexpr auto EXTENSION_BINARY = "psg_b";
@@ -21,28 +33,172 @@ export namespace pragma::shadergraph {
 		Graph(const std::shared_ptr<NodeRegistry> &nodeReg);
 		Graph(const Graph &other);
 		static void Test();
+		// Compares loading a large graph from a text file and from a binary file, as well as serial and parallel loading
+		static void BenchmarkLoad(uint32_t nodeCount = 10'000, uint32_t iterations = 10);
+		// Adds a random DAG of math nodes for the benchmarks and tests. Every node has a random operation and random constant inputs,
+		// and its first value input is linked to a random node that was added before it, as is its second one with the specified probability.
+		// The node registry of the graph must contain the math node as "math".
+		static void BuildRandomGraph(Graph &graph, uint32_t nodeCount, uint32_t seed = 123, float secondLinkProbability = 0.5f);
 		std::shared_ptr<GraphNode> AddNode(const std::string &type);
 		std::shared_ptr<GraphNode> GetNode(const std::string &name);
+		// Returns the node of the type with the lowest node index
 		std::shared_ptr<GraphNode> FindNodeByType(const std::string_view &type) const;
+		// All nodes of the type or category, ordered by node index. Both are looked up in an index instead of scanning all nodes.
+		std::vector<std::shared_ptr<GraphNode>> FindNodesByType(const std::string_view &type) const;
+		std::vector<std::shared_ptr<GraphNode>> FindNodesByCategory(const std::string_view &category) const;
+		// O(1) apart from disconnecting the links of the node. The last node is moved to the position of the removed node,
+		// so the node index of one other node may change.
 		bool RemoveNode(const std::string &name);
+		bool RemoveNode(NodeHandle handle);
+		NodeHandle GetHandle(const GraphNode &node) const;
+		// Returns nullptr if the node has been removed
+		std::shared_ptr<GraphNode> GetNode(NodeHandle handle) const;
+		bool IsValid(NodeHandle handle) const { return FindNodeIndex(handle).has_value(); }
 		const std::vector<std::shared_ptr<GraphNode>> &GetNodes() const { return m_nodes; }
 		const std::shared_ptr<NodeRegistry> &GetNodeRegistry() const { return m_nodeRegistry; }
+		// Combined structural hash of all output nodes (see GraphNode::GetStructuralHash), or of all nodes without consumers
+		// if the graph has no output nodes. Node names and order do not affect the hash.
+		hash::Hash GetStructuralHash() const;
+		// Hash of the name, type, links and input values of every node in node index order. Unlike the structural hash,
+		// it differs for graphs whose nodes are named or ordered differently, since both end up in the generated code.
+		hash::Hash GetLayoutHash() const;
 		void Clear();
 		void Merge(const Graph &other);
 		void DebugPrint();
+		// Node indices of all nodes in topological order. The order is maintained incrementally whenever a link is added
+		// (Pearce-Kelly), so it is always ready and only has to be recomputed after the graph was cleared or merged.
+		// Removed nodes are only erased from the order once it is requested.
+		// Throws std::runtime_error if the graph contains a cycle.
+		const std::vector<uint32_t> &GetTopologicalOrder() const;
+		// Snapshot of the current topology, which is rebuilt lazily after nodes or links have changed
+		const CompiledGraph &GetCompiledGraph() const { return GetTopology().compiled; }
+		// Returns true if the second node depends on the first node, directly or indirectly
+		bool IsReachable(const GraphNode &from, const GraphNode &to) const;
 		void FindInvalidLinks();
+		// Updates the code cached in the nodes (see GraphNode::MarkDirty). Concurrent calls on the same graph are serialized.
 		void GenerateGlsl(std::ostream &outHeader, std::ostream &outBody, const std::optional<std::string> &namePrefix = {}) const;
+		bool CompileBytecode(BytecodeProgram &outProgram, std::string &outErr) const;
+		// Expands all nodes (see Node::Expand)
 		void Resolve();
-		bool Load(udm::LinkedPropertyWrapper &prop, std::string &outErr);
-		bool Load(const std::string &filePath, std::string &outErr);
+		// The nodes are created by the specified number of threads (0 = all hardware threads) before they are linked.
+		// On failure, the error of the first failing node is reported, regardless of the number of threads, and the graph is left unchanged.
+		bool Load(udm::LinkedPropertyWrapper &prop, std::string &outErr, uint32_t threadCount = 1);
+		bool Load(const std::string &filePath, std::string &outErr, uint32_t threadCount = 1);
 		bool Save(udm::AssetDataArg outData, std::string &outErr) const;
 		bool Save(const std::string &filePath, std::string &outErr) const;
 	  private:
+		friend GraphNode;
+		struct TopologyCache {
+			CompiledGraph compiled;
+			// Node indices in topological order, and the position of each node index in the order
+			std::vector<uint32_t> order;
+			std::vector<uint32_t> positions;
+			// Buffers of the full sort and the incremental updates, kept so they don't have to be re-allocated
+			std::vector<uint32_t> scratch;
+			std::vector<uint32_t> searchStack;
+			std::vector<uint32_t> forward;
+			std::vector<uint32_t> backward;
+			// Number of removed nodes, which are still in the order as INVALID_INDEX
+			uint32_t numRemoved = 0;
+			// Nodes that have been visited by the current search are marked with the current epoch
+			std::vector<uint32_t> visitMarks;
+			uint32_t visitEpoch = 0;
+			bool compiledValid = false;
+			bool orderValid = false;
+			bool acyclic = false;
+		};
+		// A view shares the nodes of its base graph. Nodes are only copied into the view (materialized) once they have to be modified,
+		// e.g. by Node::Expand or by the optimization passes, so the base graph is never changed.
+		// Materialized nodes are linked to each other in both directions, but links between a materialized node and an unmodified node
+		// of the base graph only exist on the side of the materialized node. For this reason the graph must only be traversed
+		// along input links (mapped with ResolveNode) during code generation.
+		struct ViewTag {};
+		Graph(ViewTag, const Graph &base);
+		// Returns the node of this graph at the position of the specified node, which is either the node itself or its materialized copy
+		GraphNode &ResolveNode(GraphNode &node) const;
+		GraphNode &Materialize(GraphNode &node);
+		// Materializes the node, as well as all nodes linked to it
+		GraphNode &MaterializeNeighborhood(GraphNode &node);
+		bool IsNameInUse(const std::string &name) const;
+		void UpdateNameCounter(const GraphNode &node);
+
 		void AddNode(const std::shared_ptr<GraphNode> &node);
 		void DoGenerateGlsl(std::ostream &outHeader, std::ostream &outBody, const std::optional<std::string> &namePrefix);
-		std::vector<GraphNode *> TopologicalSort(const std::vector<std::shared_ptr<GraphNode>> &nodes) const;
+		bool DoCompileBytecode(BytecodeProgram &outProgram, std::string &outErr);
+		// Evaluates nodes whose inputs are all constant on the CPU and passes the results to their consumers as literals.
+		// Nodes that no longer need to be emitted are removed from sortedNodes.
+		void FoldConstants(std::vector<GraphNode *> &sortedNodes);
+		// Merges nodes of the same type with identical inputs. Consumers of a duplicate are relinked to the remaining node
+		// and the duplicate is removed from sortedNodes.
+		void EliminateCommonSubexpressions(std::vector<GraphNode *> &sortedNodes);
+		// Returns the code of the node, which is re-used from the origin node if neither it nor its inputs have changed
+		const GraphNode::GlslCode &EvaluateGlsl(GraphNode &node);
+		// The mutex only guards the lazy updates of the const methods. Modifying the graph is not thread-safe.
+		const TopologyCache &GetTopology() const;
+		void UpdateCompiledGraph() const;
+		void UpdateTopologicalOrder() const;
+		// Erases the removed nodes from the order
+		void CompactTopologicalOrder() const;
+		// Collects the nodes reachable from the start node (including itself) along output links (forward) or input links
+		// (backward), skipping nodes whose position is outside of the bound. If the target is reached, the search is aborted
+		// and true is returned.
+		bool SearchTopology(const GraphNode &start, bool forward, uint32_t bound, const GraphNode *target, std::vector<uint32_t> &outNodes) const;
+		bool WouldCreateCycle(const GraphNode &producer, const GraphNode &consumer) const;
+		void InvalidateTopology()
+		{
+			m_topology.compiledValid = false;
+			m_topology.orderValid = false;
+		}
+		void OnNodeAdded(uint32_t nodeIdx);
+		// The node at movedNodeIdx (the previous last node) has been moved to the position of the removed node
+		void OnNodeRemoved(uint32_t nodeIdx, uint32_t movedNodeIdx);
+		std::optional<size_t> FindNodeIndex(NodeHandle handle) const;
+		void AllocateSlot(uint32_t nodeIdx);
+		void ReserveNodes(size_t count);
+		std::shared_ptr<GraphNode> LoadNode(udm::LinkedPropertyWrapper &udmNode, uint32_t nodeIdx, GraphNode::LoadedLinks &outLinks, std::string &outErr);
+		bool InsertLoadedNode(const std::shared_ptr<GraphNode> &node, std::string &outErr);
+		// Removes all nodes from the index onwards, including their links to the remaining nodes, to undo a failed Load
+		void RemoveLoadedNodes(size_t firstNodeIdx);
+		// Restores the topological order after a link from the producer to the consumer has been added
+		void OnLinked(const GraphNode &producer, const GraphNode &consumer);
+		// Removing a link never invalidates the order
+		void OnUnlinked() { m_topology.compiledValid = false; }
 		std::shared_ptr<NodeRegistry> m_nodeRegistry;
 		std::vector<std::shared_ptr<GraphNode>> m_nodes;
 		std::unordered_map<std::string, size_t> m_nameToNodeIndex;
+		// Node indices grouped by a key (type or category). The position of each node in its group is stored as well,
+		// so nodes can be removed in O(1).
+		struct NodeGroups {
+			std::unordered_map<std::string_view, std::vector<uint32_t>> groups;
+			// Position in the group, by node index
+			std::vector<uint32_t> positions;
+			void Add(const std::string_view &key, uint32_t nodeIdx);
+			void Remove(const std::string_view &key, uint32_t nodeIdx);
+			// Updates the index of a node that was moved to a different position in the graph
+			void Move(const std::string_view &key, uint32_t oldNodeIdx, uint32_t newNodeIdx);
+			std::span<const uint32_t> Find(const std::string_view &key) const;
+			void Clear();
+		};
+		void AddToNodeGroups(const GraphNode &node);
+		std::vector<std::shared_ptr<GraphNode>> CollectNodes(std::span<const uint32_t> nodeIndices) const;
+		// The keys are owned by the node types, which outlive the nodes
+		NodeGroups m_typeGroups;
+		NodeGroups m_categoryGroups;
+		// Slot map for the node handles. Slots of removed nodes are re-used with an incremented generation.
+		struct Slot {
+			uint32_t nodeIndex = std::numeric_limits<uint32_t>::max();
+			uint32_t generation = 0;
+		};
+		std::vector<Slot> m_slots;
+		// Slot of each node, by node index
+		std::vector<uint32_t> m_nodeSlots;
+		std::vector<uint32_t> m_freeSlots;
+		// Number of the last name that was generated for each node type
+		std::unordered_map<const Node *, uint32_t> m_nameCounters;
+		const Graph *m_base = nullptr;
+		mutable TopologyCache m_topology;
+		mutable std::mutex m_topologyMutex;
+		// Guards the code cached in the nodes of this graph, which is written by the views created by GenerateGlsl
+		mutable std::mutex m_glslCodeMutex;
 	};
 };
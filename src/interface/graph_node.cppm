@@ -11,6 +11,7 @@ export import pragma.udm;
 
 import :socket;
 import :node;
+import :hash;
 
 export namespace pragma::shadergraph {
 	struct GraphNode;
@@ -37,17 +38,34 @@ export namespace pragma::shadergraph {
 		bool GetValue(T &outVal) const;
 		void ClearValue();
 		bool HasValue() const;
+		// Hash of the effective value, i.e. the default value if no value has been set
+		hash::Hash GetValueHash() const;
 	  private:
 		Value value;
 	};
 
 	class Graph;
 	struct GraphNode {
-		struct SocketLink {
-			std::string outputNode;
-			std::string outputName;
-
-			InputSocket *inputSocket;
+		// Links read by LoadFromAssetData, which are connected once all nodes have been loaded (see Graph::Load).
+		// Node and output names are interned, so every distinct name is only stored once, regardless of the number of links.
+		struct LoadedLinks {
+			struct StringTable {
+				uint32_t Intern(const std::string &str);
+				// A deque doesn't move its elements when it grows, so the keys of the index map stay valid
+				std::deque<std::string> strings;
+				std::unordered_map<std::string_view, uint32_t> indices;
+			};
+			struct Link {
+				// Indices into nodeNames and outputNames
+				uint32_t outputNode = 0;
+				uint32_t outputName = 0;
+				InputSocket *inputSocket = nullptr;
+			};
+			std::vector<Link> links;
+			StringTable nodeNames;
+			StringTable outputNames;
+			// Re-used for reading the names
+			std::string buffer;
 		};
 
 		const Node &node;
@@ -79,20 +97,50 @@ export namespace pragma::shadergraph {
 			auto &input = inputs[*inputIdx];
 			return input.GetValue<T>(outVal);
 		}
+		template<typename THandle, typename T>
+		bool SetInputValue(const InputHandle<THandle> &handle, const T &val)
+		{
+			return inputs.at(handle.index).SetValue<T>(val);
+		}
+		template<typename THandle, typename T>
+		bool GetInputValue(const InputHandle<THandle> &handle, T &outVal) const
+		{
+			return inputs.at(handle.index).GetValue<T>(outVal);
+		}
 		void Relink(uint32_t outputIdx, GraphNode &newNode, uint32_t newNodeOutputIdx);
 		void Relink(const std::string_view &outputName, GraphNode &newNode, const std::string_view &newNodeOutputName);
+		template<typename T, typename TNew>
+		void Relink(const OutputHandle<T> &output, GraphNode &newNode, const OutputHandle<TNew> &newNodeOutput)
+		{
+			Relink(output.index, newNode, newNodeOutput.index);
+		}
 
 		void PropagateInputSocket(uint32_t inputIdx, GraphNode &otherNode, uint32_t otherNodeInputIdx);
 		void PropagateInputSocket(const std::string_view &inputName, GraphNode &otherNode, const std::string_view &otherNodeInputName);
+		template<typename T, typename TOther>
+		void PropagateInputSocket(const InputHandle<T> &input, GraphNode &otherNode, const InputHandle<TOther> &otherNodeInput)
+		{
+			PropagateInputSocket(input.index, otherNode, otherNodeInput.index);
+		}
 
 		bool IsInputLinked(uint32_t inputIdx) const;
 		bool IsInputLinked(const std::string_view &name) const;
+		template<typename T>
+		bool IsInputLinked(const InputHandle<T> &handle) const
+		{
+			return IsInputLinked(handle.index);
+		}
 
 		std::string GetConstantValue(uint32_t inputIdx) const { return node.GetConstantValue(*this, inputIdx); }
 		std::string GetConstantValue(const std::string_view &inputName) const { return node.GetConstantValue(*this, inputName); }
 		std::string GetInputNameOrValue(uint32_t inputIdx) const { return node.GetInputNameOrValue(*this, inputIdx); }
 		std::string GetInputNameOrValue(const std::string_view &inputName) const { return node.GetInputNameOrValue(*this, inputName); }
 
+		template<typename T>
+		const InputSocket *FindInputSocket(const InputHandle<T> &handle) const
+		{
+			return GetInput(handle.index);
+		}
 		const InputSocket *FindInputSocket(const std::string_view &inputName) const
 		{
 			auto &nodeInputs = node.GetInputs();
@@ -121,6 +169,18 @@ export namespace pragma::shadergraph {
 				return {};
 			});
 		}
+		// The value type defaults to the type of the handle
+		template<typename T = void, typename THandle>
+		std::optional<std::conditional_t<std::is_void_v<T>, THandle, T>> GetConstantInputValue(const InputHandle<THandle> &handle) const
+		{
+			using TValue = std::conditional_t<std::is_void_v<T>, THandle, T>;
+			if constexpr(std::is_enum_v<TValue>) {
+				auto v = GetConstantInputValue<std::underlying_type_t<TValue>>(handle.index);
+				return v ? static_cast<TValue>(*v) : std::optional<TValue> {};
+			}
+			else
+				return GetConstantInputValue<TValue>(handle.index);
+		}
 		template<typename T>
 		std::optional<T> GetConstantInputValue(const std::string_view &inputName) const
 		{
@@ -155,6 +215,11 @@ export namespace pragma::shadergraph {
 		bool CanLink(uint32_t outputIdx, GraphNode &linkTarget, uint32_t inputIdx) const;
 		bool Link(const std::string_view &outputName, GraphNode &linkTarget, const std::string_view &inputName, std::string *optOutErr = nullptr);
 		bool Link(uint32_t outputIdx, GraphNode &linkTarget, uint32_t inputIdx, std::string *optOutErr = nullptr);
+		template<typename TOutput, typename TInput>
+		bool Link(const OutputHandle<TOutput> &output, GraphNode &linkTarget, const InputHandle<TInput> &input, std::string *optOutErr = nullptr)
+		{
+			return Link(output.index, linkTarget, input.index, optOutErr);
+		}
 
 		bool IsOutputLinked(const std::string_view &name) const;
 		std::optional<size_t> FindOutputIndex(const std::string_view &name) const;
@@ -168,31 +233,66 @@ export namespace pragma::shadergraph {
 		const InputSocket *GetInput(size_t index) const { return const_cast<GraphNode *>(this)->GetInput(index); }
 		const OutputSocket *GetOutput(size_t index) const { return const_cast<GraphNode *>(this)->GetOutput(index); }
 
-		std::string GetBaseVarName() const;
-		std::string GetVarName(const std::string &var) const;
-		std::string GetOutputVarName(size_t outputIdx) const;
-		std::string GetOutputVarName(const std::string_view &name) const;
+		// Variable names are interned when the node index is assigned, see SetNodeIndex
+		std::string_view GetBaseVarName() const { return std::string_view {m_varNames}.substr(0, m_varNameOffsets.front()); }
+		std::string GetVarName(const std::string_view &var) const;
+		std::string_view GetOutputVarName(size_t outputIdx) const;
+		std::string_view GetOutputVarName(const std::string_view &name) const;
 
 		const Vector2 &GetPos() const { return m_pos; }
 		void SetPos(const Vector2 &pos) { m_pos = pos; }
 
+		// Merkle-style hash of the node type, its input values and the hashes of all linked upstream nodes.
+		// Names, positions and display names are ignored. The hash is cached until the node is marked as dirty.
+		hash::Hash GetStructuralHash() const;
+		// Invalidates the structural hash and the cached GLSL code of this node and all nodes downstream of it.
+		// Called automatically whenever an input is changed, linked or disconnected.
+		void MarkDirty();
+		bool IsDirty() const { return m_dirty; }
+
 		bool Save(udm::LinkedPropertyWrapper &prop) const;
-		bool LoadFromAssetData(udm::LinkedPropertyWrapper &prop, std::vector<SocketLink> &outLinks, std::string &outErr);
+		bool LoadFromAssetData(udm::LinkedPropertyWrapper &prop, LoadedLinks &outLinks, std::string &outErr);
 
 		friend Graph;
 		Graph &graph;
+		// Position of the node in the graph. Use SetNodeIndex to change it, so the variable names are updated as well.
 		uint32_t nodeIndex = std::numeric_limits<uint32_t>::max();
 		std::string m_name;
 		std::optional<std::string> m_displayName {};
 	  private:
 		void SetName(const std::string &name) { m_name = name; }
+		void SetNodeIndex(uint32_t index);
 		Vector2 m_pos {};
+		// Base variable name ("var<nodeIndex>"), followed by the variable name of each output ("var<nodeIndex>_<outputIndex>").
+		// m_varNameOffsets contains the end offset of each name.
+		std::string m_varNames;
+		std::vector<uint32_t> m_varNameOffsets;
+		mutable hash::Hash m_structuralHash = 0;
+		mutable bool m_structuralHashValid = false;
+		mutable bool m_computingStructuralHash = false;
+
+		// Code generated for this node by the last call to Graph::GenerateGlsl. If the node was copied during code generation
+		// (see Graph::Materialize), the copy points to its origin node, which holds the cache. Access is guarded by the
+		// GLSL code mutex of the graph the node belongs to.
+		struct GlslCode {
+			// Hash of everything the generated code depends on in the copied graph (node index, linked outputs and input values)
+			hash::Hash signature = 0;
+			std::string resourceDeclarations;
+			std::string code;
+			bool valid = false;
+		};
+		GlslCode m_glslCode {};
+		GraphNode *m_origin = nullptr;
+		bool m_dirty = true;
 	};
 
 	template<typename T>
 	bool InputSocket::SetValue(const T &val)
 	{
-		return value.Set<T>(val);
+		if(!value.Set<T>(val))
+			return false;
+		parent->MarkDirty();
+		return true;
 	}
 	template<typename T>
 	bool InputSocket::GetValue(T &outVal) const
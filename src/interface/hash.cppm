@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+export module pragma.shadergraph:hash;
+
+export import pragma.util;
+
+export namespace pragma::shadergraph::hash {
+	// Stable across runs and platforms (unlike std::hash), so hashes can be persisted
+	using Hash = uint64_t;
+	constexpr Hash FNV_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr Hash FNV_PRIME = 1099511628211ull;
+
+	inline Hash hash_bytes(const void *data, size_t size, Hash seed = FNV_OFFSET_BASIS)
+	{
+		auto *bytes = static_cast<const uint8_t *>(data);
+		auto h = seed;
+		for(size_t i = 0; i < size; ++i) {
+			h ^= bytes[i];
+			h *= FNV_PRIME;
+		}
+		return h;
+	}
+	inline Hash hash_string(const std::string_view &str, Hash seed = FNV_OFFSET_BASIS) { return hash_bytes(str.data(), str.size(), seed); }
+	template<typename T>
+	    requires(std::is_trivially_copyable_v<T>)
+	Hash hash_value(const T &value, Hash seed = FNV_OFFSET_BASIS)
+	{
+		return hash_bytes(&value, sizeof(value), seed);
+	}
+	constexpr Hash hash_combine(Hash seed, Hash value)
+	{
+		// 64-bit variant of boost::hash_combine
+		return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4));
+	}
+};
@@ -0,0 +1,384 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+
+// SSE2 is part of every x86-64 target, so the batched kernels are always vectorized on x86-64, even without any ISA flags
+#if defined(__AVX2__) || defined(__SSE4_1__) || defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PSG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+export module pragma.shadergraph:kernel;
+
+import :parameter;
+
+export namespace pragma::shadergraph {
+	using Register = uint32_t;
+	constexpr Register INVALID_REGISTER = std::numeric_limits<Register>::max();
+
+	// Number of float registers required to hold a value of the specified type.
+	// Types that cannot be evaluated on the CPU return 0.
+	constexpr uint32_t get_register_count(DataType type)
+	{
+		switch(type) {
+		case DataType::Boolean:
+		case DataType::Int:
+		case DataType::UInt:
+		case DataType::Float:
+		case DataType::Half:
+		case DataType::UInt16:
+		case DataType::Enum:
+			return 1;
+		case DataType::Color:
+		case DataType::Vector:
+		case DataType::Point:
+		case DataType::Normal:
+			return 3;
+		case DataType::Vector4:
+			return 4;
+		case DataType::Point2:
+			return 2;
+		case DataType::String:
+		case DataType::Transform:
+			return 0;
+		}
+		static_assert(math::to_integral(DataType::Count) == 15, "Update the list above when adding new types!");
+		return 0;
+	}
+
+	template<typename T>
+	void store_registers(float *dst, const T &value)
+	{
+		if constexpr(std::is_same_v<T, udm::Vector2>) {
+			dst[0] = value.x;
+			dst[1] = value.y;
+		}
+		else if constexpr(std::is_same_v<T, udm::Vector3>) {
+			dst[0] = value.x;
+			dst[1] = value.y;
+			dst[2] = value.z;
+		}
+		else if constexpr(std::is_same_v<T, udm::Vector4>) {
+			dst[0] = value.x;
+			dst[1] = value.y;
+			dst[2] = value.z;
+			dst[3] = value.w;
+		}
+		else if constexpr(std::is_same_v<T, udm::Boolean>)
+			dst[0] = value ? 1.f : 0.f;
+		else if constexpr(std::is_same_v<T, udm::Half>)
+			dst[0] = static_cast<float>(value);
+		else if constexpr(std::is_arithmetic_v<T>)
+			dst[0] = static_cast<float>(value);
+		else
+			throw std::invalid_argument {"Type '" + std::string {typeid(T).name()} + "' cannot be stored in registers!"};
+	}
+
+	template<typename T>
+	T load_registers(const float *src)
+	{
+		if constexpr(std::is_same_v<T, udm::Vector2>)
+			return T {src[0], src[1]};
+		else if constexpr(std::is_same_v<T, udm::Vector3>)
+			return T {src[0], src[1], src[2]};
+		else if constexpr(std::is_same_v<T, udm::Vector4>)
+			return T {src[0], src[1], src[2], src[3]};
+		else if constexpr(std::is_same_v<T, udm::Boolean>)
+			return src[0] > 0.5f;
+		else if constexpr(std::is_same_v<T, udm::Half>)
+			return T {src[0]};
+		else if constexpr(std::is_arithmetic_v<T>)
+			return static_cast<T>(src[0]);
+		else
+			throw std::invalid_argument {"Type '" + std::string {typeid(T).name()} + "' cannot be loaded from registers!"};
+	}
+
+	// Arguments passed to a node's CPU kernel. Input and output sockets are addressed by their index,
+	// each of which maps to the first of the float registers that hold the socket's value.
+	// The components of a register are 'stride' floats apart, which allows kernels to operate on a single lane of a batch.
+	class KernelArgs {
+	  public:
+		KernelArgs(uint32_t variant, float *registers, const Register *inputs, const Register *outputs, uint32_t stride = 1) : m_variant {variant}, m_registers {registers}, m_inputs {inputs}, m_outputs {outputs}, m_stride {stride} {}
+
+		uint32_t GetVariant() const { return m_variant; }
+		template<typename T>
+		T GetVariant() const
+		{
+			return static_cast<T>(m_variant);
+		}
+
+		float GetFloat(uint32_t inputIdx) const { return m_registers[m_inputs[inputIdx] * m_stride]; }
+		bool GetBool(uint32_t inputIdx) const { return GetFloat(inputIdx) > 0.5f; }
+		Vector3 GetVector3(uint32_t inputIdx) const
+		{
+			auto *r = m_registers + m_inputs[inputIdx] * m_stride;
+			return Vector3 {r[0], r[m_stride], r[m_stride * 2]};
+		}
+
+		void SetFloat(uint32_t outputIdx, float value) const { m_registers[m_outputs[outputIdx] * m_stride] = value; }
+		void SetVector3(uint32_t outputIdx, const Vector3 &value) const
+		{
+			auto *r = m_registers + m_outputs[outputIdx] * m_stride;
+			r[0] = value.x;
+			r[m_stride] = value.y;
+			r[m_stride * 2] = value.z;
+		}
+	  private:
+		uint32_t m_variant;
+		float *m_registers;
+		const Register *m_inputs;
+		const Register *m_outputs;
+		uint32_t m_stride;
+	};
+
+	// Arguments passed to a node's batched CPU kernel. Registers are stored as structure-of-arrays, i.e. every register
+	// is a stream of one float per lane, and multi-component values (e.g. Vector3) occupy one stream per component.
+	// The lane count is always a multiple of kernel::simd::WIDTH.
+	class BatchKernelArgs {
+	  public:
+		BatchKernelArgs(uint32_t variant, float *registers, uint32_t laneCount, const Register *inputs, const Register *outputs) : m_variant {variant}, m_registers {registers}, m_laneCount {laneCount}, m_inputs {inputs}, m_outputs {outputs} {}
+
+		uint32_t GetVariant() const { return m_variant; }
+		template<typename T>
+		T GetVariant() const
+		{
+			return static_cast<T>(m_variant);
+		}
+		uint32_t GetLaneCount() const { return m_laneCount; }
+
+		const float *GetInputStream(uint32_t inputIdx, uint32_t component = 0) const { return m_registers + (m_inputs[inputIdx] + component) * m_laneCount; }
+		float *GetOutputStream(uint32_t outputIdx, uint32_t component = 0) const { return m_registers + (m_outputs[outputIdx] + component) * m_laneCount; }
+
+		// Scalar view of a single lane
+		KernelArgs GetLane(uint32_t lane) const { return KernelArgs {m_variant, m_registers + lane, m_inputs, m_outputs, m_laneCount}; }
+	  private:
+		uint32_t m_variant;
+		float *m_registers;
+		uint32_t m_laneCount;
+		const Register *m_inputs;
+		const Register *m_outputs;
+	};
+
+	// CPU equivalents of the GLSL built-ins and module functions used by the nodes
+	namespace kernel {
+		constexpr float FLOAT_EPSILON = 1.192092896e-07f;
+		constexpr float PI = 3.14159265358979323846f;
+
+		inline float fract(float x) { return x - std::floor(x); }
+		// Same definition as in GLSL, so a divisor of 0 results in NaN (which prevents constant folding) rather than an arbitrary value
+		inline float mod(float x, float y) { return x - y * std::floor(x / y); }
+		inline float sign(float x) { return (x > 0.f) ? 1.f : ((x < 0.f) ? -1.f : 0.f); }
+		inline float clamp(float x, float min, float max) { return std::min(std::max(x, min), max); }
+		inline float mix(float a, float b, float t) { return a * (1.f - t) + b * t; }
+		inline float wrap(float value, float max, float min)
+		{
+			auto range = max - min;
+			return (range != 0.f) ? value - (range * std::floor((value - min) / range)) : min;
+		}
+		// Same as compare in the math module, which the map range node uses to skip degenerate ranges: the values are only considered
+		// different if they are further apart than FLT_EPSILON
+		inline bool compare(float a, float b) { return std::abs(a - b) > FLOAT_EPSILON; }
+		inline float pingpong(float a, float b) { return (b != 0.f) ? std::abs(fract((a - b) / (b * 2.f)) * b * 2.f - b) : 0.f; }
+		inline float smoothmin(float a, float b, float c)
+		{
+			if(c == 0.f)
+				return std::min(a, b);
+			auto h = std::max(c - std::abs(a - b), 0.f) / c;
+			return std::min(a, b) - h * h * h * c * (1.f / 6.f);
+		}
+		inline float smoothstep(float edge0, float edge1, float x)
+		{
+			auto t = clamp((x - edge0) / (edge1 - edge0), 0.f, 1.f);
+			return t * t * (3.f - 2.f * t);
+		}
+		inline float smootherstep(float edge0, float edge1, float x)
+		{
+			auto t = clamp((x - edge0) / (edge1 - edge0), 0.f, 1.f);
+			return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+		}
+
+		inline float dot(const Vector3 &a, const Vector3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+		inline float length(const Vector3 &v) { return std::sqrt(dot(v, v)); }
+		inline Vector3 cross(const Vector3 &a, const Vector3 &b) { return Vector3 {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+		inline Vector3 normalize(const Vector3 &v)
+		{
+			auto l = length(v);
+			return (l != 0.f) ? v / l : Vector3 {0.f, 0.f, 0.f};
+		}
+		inline Vector3 mix(const Vector3 &a, const Vector3 &b, float t) { return a * (1.f - t) + b * t; }
+		inline Vector3 clamp(const Vector3 &v, float min, float max) { return Vector3 {clamp(v.x, min, max), clamp(v.y, min, max), clamp(v.z, min, max)}; }
+		inline Vector3 max(const Vector3 &v, float min) { return Vector3 {std::max(v.x, min), std::max(v.y, min), std::max(v.z, min)}; }
+
+		inline Vector3 rgb_to_hsv(const Vector3 &rgb)
+		{
+			auto cmax = std::max(rgb.x, std::max(rgb.y, rgb.z));
+			auto cmin = std::min(rgb.x, std::min(rgb.y, rgb.z));
+			auto cdelta = cmax - cmin;
+			auto v = cmax;
+			auto s = (cmax != 0.f) ? cdelta / cmax : 0.f;
+			auto h = 0.f;
+			if(s != 0.f) {
+				auto c = (Vector3 {cmax, cmax, cmax} - rgb) / cdelta;
+				if(rgb.x == cmax)
+					h = c.z - c.y;
+				else if(rgb.y == cmax)
+					h = 2.f + c.x - c.z;
+				else
+					h = 4.f + c.y - c.x;
+				h /= 6.f;
+				if(h < 0.f)
+					h += 1.f;
+			}
+			return Vector3 {h, s, v};
+		}
+		inline Vector3 hsv_to_rgb(const Vector3 &hsv)
+		{
+			auto h = hsv.x;
+			auto s = hsv.y;
+			auto v = hsv.z;
+			if(s == 0.f)
+				return Vector3 {v, v, v};
+			if(h == 1.f)
+				h = 0.f;
+			h *= 6.f;
+			auto i = std::floor(h);
+			auto f = h - i;
+			auto p = v * (1.f - s);
+			auto q = v * (1.f - (s * f));
+			auto t = v * (1.f - (s * (1.f - f)));
+			switch(static_cast<int32_t>(i)) {
+			case 0:
+				return Vector3 {v, t, p};
+			case 1:
+				return Vector3 {q, v, p};
+			case 2:
+				return Vector3 {p, v, t};
+			case 3:
+				return Vector3 {p, q, v};
+			case 4:
+				return Vector3 {t, p, v};
+			}
+			return Vector3 {v, p, q};
+		}
+	};
+
+	// Minimal SIMD abstraction used by the batched kernels. Uses AVX2 or SSE4.1 if enabled for the build, otherwise SSE2 on x86,
+	// and plain scalar code with a width of 1 on all other architectures.
+	namespace kernel::simd {
+#if defined(__AVX2__)
+		constexpr std::string_view INSTRUCTION_SET = "AVX2";
+		using Float = __m256;
+		constexpr uint32_t WIDTH = 8;
+		inline Float load(const float *p) { return _mm256_loadu_ps(p); }
+		inline void store(float *p, Float v) { _mm256_storeu_ps(p, v); }
+		inline Float set1(float v) { return _mm256_set1_ps(v); }
+		inline Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+		inline Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+		inline Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+		inline Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+		inline Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+		inline Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+		inline Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+		inline Float floor(Float a) { return _mm256_floor_ps(a); }
+		inline Float ceil(Float a) { return _mm256_ceil_ps(a); }
+		inline Float trunc(Float a) { return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+		inline Float round(Float a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		inline Float abs(Float a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+		// Comparisons return a lane mask for use with select
+		inline Float less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		inline Float less_equal(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		inline Float greater(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		inline Float not_equal(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+		inline Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+#elif defined(PSG_SIMD_X86)
+		using Float = __m128;
+		constexpr uint32_t WIDTH = 4;
+		inline Float load(const float *p) { return _mm_loadu_ps(p); }
+		inline void store(float *p, Float v) { _mm_storeu_ps(p, v); }
+		inline Float set1(float v) { return _mm_set1_ps(v); }
+		inline Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+		inline Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+		inline Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+		inline Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+		inline Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+		inline Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+		inline Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+		inline Float abs(Float a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+		inline Float less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+		inline Float less_equal(Float a, Float b) { return _mm_cmple_ps(a, b); }
+		inline Float greater(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+		inline Float not_equal(Float a, Float b) { return _mm_cmpneq_ps(a, b); }
+#if defined(__SSE4_1__) || defined(__AVX__)
+		constexpr std::string_view INSTRUCTION_SET = "SSE4.1";
+		inline Float floor(Float a) { return _mm_floor_ps(a); }
+		inline Float ceil(Float a) { return _mm_ceil_ps(a); }
+		inline Float trunc(Float a) { return _mm_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+		inline Float round(Float a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		inline Float select(Float mask, Float a, Float b) { return _mm_blendv_ps(b, a, mask); }
+#else
+		constexpr std::string_view INSTRUCTION_SET = "SSE2";
+		inline Float select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		// SSE2 has no rounding instructions, so the values are converted to integers and back. Floats with a magnitude of at least 2^23
+		// (as well as infinity and NaN) are integral already and are returned unchanged. The sign is restored, so that e.g. -0.5 is
+		// truncated to -0.0, as with the SSE4.1 instructions.
+		inline Float to_integral(Float a, __m128i i)
+		{
+			auto signMask = _mm_set1_ps(-0.f);
+			auto integral = _mm_or_ps(_mm_cvtepi32_ps(i), _mm_and_ps(a, signMask));
+			return select(_mm_cmplt_ps(_mm_andnot_ps(signMask, a), _mm_set1_ps(8388608.f)), integral, a);
+		}
+		inline Float trunc(Float a) { return to_integral(a, _mm_cvttps_epi32(a)); }
+		// Uses the rounding mode of the thread, which is round to nearest even by default (as with std::nearbyint)
+		inline Float round(Float a) { return to_integral(a, _mm_cvtps_epi32(a)); }
+		inline Float floor(Float a)
+		{
+			auto t = trunc(a);
+			return sub(t, _mm_and_ps(greater(t, a), _mm_set1_ps(1.f)));
+		}
+		inline Float ceil(Float a)
+		{
+			// Adding 0 would turn -0.0 into 0.0, so the sign is restored
+			auto t = trunc(a);
+			return _mm_or_ps(add(t, _mm_and_ps(less(t, a), _mm_set1_ps(1.f))), _mm_and_ps(a, _mm_set1_ps(-0.f)));
+		}
+#endif
+#else
+		constexpr std::string_view INSTRUCTION_SET = "scalar";
+		struct Float {
+			float value;
+			bool mask;
+		};
+		constexpr uint32_t WIDTH = 1;
+		inline Float load(const float *p) { return {*p, false}; }
+		inline void store(float *p, Float v) { *p = v.value; }
+		inline Float set1(float v) { return {v, false}; }
+		inline Float add(Float a, Float b) { return {a.value + b.value, false}; }
+		inline Float sub(Float a, Float b) { return {a.value - b.value, false}; }
+		inline Float mul(Float a, Float b) { return {a.value * b.value, false}; }
+		inline Float div(Float a, Float b) { return {a.value / b.value, false}; }
+		inline Float min(Float a, Float b) { return {std::min(a.value, b.value), false}; }
+		inline Float max(Float a, Float b) { return {std::max(a.value, b.value), false}; }
+		inline Float sqrt(Float a) { return {std::sqrt(a.value), false}; }
+		inline Float floor(Float a) { return {std::floor(a.value), false}; }
+		inline Float ceil(Float a) { return {std::ceil(a.value), false}; }
+		inline Float trunc(Float a) { return {std::trunc(a.value), false}; }
+		inline Float round(Float a) { return {std::nearbyint(a.value), false}; }
+		inline Float abs(Float a) { return {std::abs(a.value), false}; }
+		inline Float less(Float a, Float b) { return {0.f, a.value < b.value}; }
+		inline Float less_equal(Float a, Float b) { return {0.f, a.value <= b.value}; }
+		inline Float greater(Float a, Float b) { return {0.f, a.value > b.value}; }
+		inline Float not_equal(Float a, Float b) { return {0.f, a.value != b.value}; }
+		inline Float select(Float mask, Float a, Float b) { return mask.mask ? a : b; }
+#endif
+		inline Float fract(Float a) { return sub(a, floor(a)); }
+		inline Float clamp(Float a, Float min, Float max) { return simd::min(simd::max(a, min), max); }
+		// Same as kernel::mod
+		inline Float mod(Float a, Float b) { return sub(a, mul(b, floor(div(a, b)))); }
+		inline Float sign(Float a) { return select(greater(a, set1(0.f)), set1(1.f), select(less(a, set1(0.f)), set1(-1.f), set1(0.f))); }
+
+		constexpr uint32_t get_padded_lane_count(uint32_t laneCount) { return ((laneCount + WIDTH - 1) / WIDTH) * WIDTH; }
+	};
+};
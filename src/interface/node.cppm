@@ -8,6 +8,7 @@ module;
 export module pragma.shadergraph:node;
 
 import :socket;
+import :kernel;
 export namespace pragma::shadergraph {
 	constexpr std::string_view CATEGORY_INPUT_PARAMETER = "input_parameter";
 	constexpr std::string_view CATEGORY_INPUT_SYSTEM = "input_system";
@@ -23,6 +24,9 @@ export namespace pragma::shadergraph {
 
 	class Graph;
 	struct GraphNode;
+	class CodeWriter;
+	// Node types are shared by all graphs created from the same registry, possibly across threads. Derived types must therefore
+	// not modify any state after construction; all per-instance data belongs in the GraphNode.
 	class Node {
 	  public:
 		Node(const std::string_view &type, const std::string_view &category);
@@ -38,10 +42,28 @@ export namespace pragma::shadergraph {
 		std::string GetInputNameOrValue(const GraphNode &instance, const std::string_view &inputName) const;
 		const std::vector<std::string> &GetModuleDependencies() const { return m_dependencies; }
 
+		// Expand may replace the node with other nodes before code generation. It may only modify the node itself,
+		// the nodes linked to it and nodes it adds to the graph. Nodes that override Expand must also override HasExpansion.
 		virtual void Expand(Graph &graph, GraphNode &gn) const {}
+		virtual bool HasExpansion() const { return false; }
+		// Output nodes are the roots of code generation. Nodes that no output node depends on are not emitted.
+		virtual bool IsOutputNode() const { return m_category == CATEGORY_OUTPUT; }
 
+		// Appends the code of the node to the writer
+		void Evaluate(const Graph &graph, const GraphNode &instance, CodeWriter &writer) const;
+		void EvaluateResourceDeclarations(const Graph &graph, const GraphNode &instance, CodeWriter &writer) const;
 		std::string Evaluate(const Graph &graph, const GraphNode &instance) const;
 		std::string EvaluateResourceDeclarations(const Graph &graph, const GraphNode &instance) const;
+
+		// CPU evaluation of the node, used by the bytecode interpreter.
+		// The variant is a per-instance constant (e.g. the operation of a math node) that is resolved at compile time.
+		virtual bool HasKernel() const { return false; }
+		virtual uint32_t GetKernelVariant(const GraphNode &instance) const { return 0; }
+		// Whether the kernel can be evaluated with the variant, used to validate variants that weren't returned by GetKernelVariant
+		// (e.g. from a baked graph). Nodes that override GetKernelVariant must also override this.
+		virtual bool IsValidKernelVariant(uint32_t variant) const { return variant == 0; }
+		void EvaluateKernel(const KernelArgs &args) const;
+		void EvaluateKernelBatch(const BatchKernelArgs &args) const;
 		template<typename TEnum>
 		    requires(std::is_enum_v<TEnum>)
 		void AddSocketEnum(const std::string &name, TEnum defaultVal, bool linkable = false)
@@ -60,6 +82,33 @@ export namespace pragma::shadergraph {
 		Socket &AddInput(const std::string &name, DataType type, T defaultVal, float min = 0.f, float max = 1.f);
 		Socket &AddOutput(const std::string &name, DataType type);
 
+		// Same as above, but additionally verify that the socket is added at the position of the handle
+		template<typename TEnum>
+		    requires(std::is_enum_v<TEnum>)
+		void AddSocketEnum(const InputHandle<TEnum> &handle, TEnum defaultVal, bool linkable = false)
+		{
+			ValidateHandle(m_inputs, handle.name, handle.index);
+			AddSocketEnum<TEnum>(std::string {handle.name}, defaultVal, linkable);
+		}
+		template<typename THandle, typename T>
+		Socket &AddSocket(const InputHandle<THandle> &handle, DataType type, T defaultVal, float min = 0.f, float max = 1.f)
+		{
+			ValidateHandle(m_inputs, handle.name, handle.index);
+			return AddSocket<T>(handle.name, type, defaultVal, min, max);
+		}
+		template<typename THandle, typename T>
+		Socket &AddInput(const InputHandle<THandle> &handle, DataType type, T defaultVal, float min = 0.f, float max = 1.f)
+		{
+			ValidateHandle(m_inputs, handle.name, handle.index);
+			return AddInput<T>(handle.name, type, defaultVal, min, max);
+		}
+		template<typename THandle>
+		Socket &AddOutput(const OutputHandle<THandle> &handle, DataType type)
+		{
+			ValidateHandle(m_outputs, handle.name, handle.index);
+			return AddOutput(handle.name, type);
+		}
+
 		std::optional<size_t> FindOutputIndex(const std::string_view &name) const;
 		std::optional<size_t> FindInputIndex(const std::string_view &name) const;
 		const std::vector<Socket> &GetInputs() const;
@@ -70,9 +119,14 @@ export namespace pragma::shadergraph {
 		std::string GetGlslOutputDeclaration(const GraphNode &instance, uint32_t outputIdx) const;
 		std::string GetGlslOutputDeclaration(const GraphNode &instance, const std::string_view &name) const;
 	  protected:
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const = 0;
-		virtual std::string DoEvaluateResourceDeclarations(const Graph &graph, const GraphNode &instance) const { return ""; }
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &writer) const = 0;
+		virtual void DoEvaluateResourceDeclarations(const Graph &graph, const GraphNode &instance, CodeWriter &writer) const {}
+		virtual void DoEvaluateKernel(const KernelArgs &args) const;
+		// Default implementation evaluates the scalar kernel for each lane
+		virtual void DoEvaluateKernelBatch(const BatchKernelArgs &args) const;
 		void AddModuleDependency(const std::string &name) { m_dependencies.push_back(name); }
+		// Whether the value is part of the enum set of the input, for kernel variants that are determined by an enum input
+		bool IsEnumInputValue(uint32_t inputIdx, uint32_t value) const;
 
 		std::string_view m_type;
 		std::string_view m_category;
@@ -81,6 +135,7 @@ export namespace pragma::shadergraph {
 		std::vector<std::string> m_dependencies;
 	  private:
 		Socket &AddSocket(const std::string &name, DataType type, float min, float max);
+		void ValidateHandle(const std::vector<Socket> &sockets, const std::string_view &name, uint32_t index) const;
 	};
 
 	template<typename T>
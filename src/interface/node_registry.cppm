@@ -6,8 +6,11 @@ module;
 export module pragma.shadergraph:node_registry;
 
 import :node;
+import :hash;
 
 export namespace pragma::shadergraph {
+	// Registration is not thread-safe. Once all node types have been registered, the registry and its node types may be
+	// shared read-only between any number of threads, e.g. to compile multiple graphs concurrently (see BatchCompiler).
 	class NodeRegistry {
 	  public:
 		NodeRegistry();
@@ -27,9 +30,15 @@ export namespace pragma::shadergraph {
 		void GetNodeTypes(std::vector<std::string> &outNames) const;
 		void AddChildRegistry(const std::shared_ptr<NodeRegistry> &registry) { m_childRegistries.push_back(registry); }
 		const std::vector<std::shared_ptr<NodeRegistry>> &GetChildRegistries() const { return m_childRegistries; }
+		// Hash of all registered node types, including their sockets, default values and module dependencies,
+		// as well as the fingerprints of the child registries.
+		hash::Hash GetFingerprint() const;
 	  private:
 		void RegisterNode(const std::string &name, const std::shared_ptr<Node> &node);
 		std::unordered_map<std::string, std::shared_ptr<Node>> m_nodes;
 		std::vector<std::shared_ptr<NodeRegistry>> m_childRegistries;
+		// Sum of the hashes of all registered node types, so it doesn't depend on the order of registration. It is updated
+		// on registration rather than computed lazily, so GetFingerprint doesn't modify any state and is safe to call from any thread.
+		hash::Hash m_nodeHashSum = 0;
 	};
 };
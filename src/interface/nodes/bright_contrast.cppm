@@ -10,14 +10,17 @@ export namespace pragma::shadergraph {
 
 	class BrightContrastNode : public Node {
 	  public:
-		static constexpr const char *IN_COLOR = "color";
-		static constexpr const char *IN_BRIGHT = "bright";
-		static constexpr const char *IN_CONTRAST = "contrast";
+		static constexpr InputHandle<udm::Vector3> IN_COLOR {"color", 0};
+		static constexpr InputHandle<float> IN_BRIGHT {"bright", 1};
+		static constexpr InputHandle<float> IN_CONTRAST {"contrast", 2};
 
-		static constexpr const char *OUT_COLOR = "color";
+		static constexpr OutputHandle<udm::Vector3> OUT_COLOR {"color", 0};
 
 		BrightContrastNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -15,16 +15,21 @@ export namespace pragma::shadergraph {
 			Range,
 		};
 
-		static constexpr const char *CONST_CLAMP_TYPE = "clampType";
+		static constexpr InputHandle<ClampType> CONST_CLAMP_TYPE {"clampType", 0};
 
-		static constexpr const char *IN_VALUE = "value";
-		static constexpr const char *IN_MIN = "min";
-		static constexpr const char *IN_MAX = "max";
+		static constexpr InputHandle<float> IN_VALUE {"value", 1};
+		static constexpr InputHandle<float> IN_MIN {"min", 2};
+		static constexpr InputHandle<float> IN_MAX {"max", 3};
 
-		static constexpr const char *OUT_RESULT = "result";
+		static constexpr OutputHandle<float> OUT_RESULT {"result", 0};
 
 		ClampNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual uint32_t GetKernelVariant(const GraphNode &instance) const override;
+		virtual bool IsValidKernelVariant(uint32_t variant) const override { return IsEnumInputValue(CONST_CLAMP_TYPE.index, variant); }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
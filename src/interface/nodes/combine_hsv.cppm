@@ -10,14 +10,17 @@ export namespace pragma::shadergraph {
 
 	class CombineHsvNode : public Node {
 	  public:
-		static constexpr const char *IN_H = "h";
-		static constexpr const char *IN_S = "s";
-		static constexpr const char *IN_V = "v";
+		static constexpr InputHandle<float> IN_H {"h", 0};
+		static constexpr InputHandle<float> IN_S {"s", 1};
+		static constexpr InputHandle<float> IN_V {"v", 2};
 
-		static constexpr const char *OUT_COLOR = "color";
+		static constexpr OutputHandle<udm::Vector3> OUT_COLOR {"color", 0};
 
 		CombineHsvNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
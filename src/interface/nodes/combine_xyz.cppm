@@ -11,14 +11,17 @@ export namespace pragma::shadergraph {
 
 	class CombineXyzNode : public Node {
 	  public:
-		static constexpr const char *IN_X = "x";
-		static constexpr const char *IN_Y = "y";
-		static constexpr const char *IN_Z = "z";
+		static constexpr InputHandle<float> IN_X {"x", 0};
+		static constexpr InputHandle<float> IN_Y {"y", 1};
+		static constexpr InputHandle<float> IN_Z {"z", 2};
 
-		static constexpr const char *OUT_VECTOR = "vector";
+		static constexpr OutputHandle<udm::Vector3> OUT_VECTOR {"vector", 0};
 
 		CombineXyzNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -20,18 +20,21 @@ export namespace pragma::shadergraph {
 			Multiply,
 		};
 
-		static constexpr const char *IN_COLOR = "color";
-		static constexpr const char *IN_EMISSION_COLOR = "emissionColor";
-		static constexpr const char *IN_EMISSION_ALPHA = "emissionAlpha";
-		static constexpr const char *IN_BASE_COLOR = "baseColor";
-		static constexpr const char *IN_EMISSION_MODE = "emissionMode";
-		static constexpr const char *IN_EMISSION_FACTOR = "emissionFactor";
+		static constexpr InputHandle<udm::Vector3> IN_COLOR {"color", 0};
+		static constexpr InputHandle<udm::Vector3> IN_EMISSION_COLOR {"emissionColor", 1};
+		static constexpr InputHandle<float> IN_EMISSION_ALPHA {"emissionAlpha", 2};
+		static constexpr InputHandle<udm::Vector3> IN_BASE_COLOR {"baseColor", 3};
+		static constexpr InputHandle<EmissionMode> IN_EMISSION_MODE {"emissionMode", 5};
+		static constexpr InputHandle<float> IN_EMISSION_FACTOR {"emissionFactor", 4};
 
-		static constexpr const char *OUT_COLOR = "color";
-		static constexpr const char *OUT_EMISSION_COLOR = "emissionColor";
+		static constexpr OutputHandle<udm::Vector3> OUT_COLOR {"color", 0};
+		static constexpr OutputHandle<udm::Vector3> OUT_EMISSION_COLOR {"emissionColor", 1};
 
 		EmissionNode(const std::string_view &type);
+		virtual bool IsOutputNode() const override { return true; }
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		// The node has no CPU kernel, since apply_emission_color is defined by the external emission module, which a kernel could only
+		// approximate. It is therefore never folded into a constant or baked.
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
 	};
 };
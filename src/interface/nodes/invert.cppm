@@ -10,13 +10,16 @@ export namespace pragma::shadergraph {
 
 	class InvertNode : public Node {
 	  public:
-		static constexpr const char *IN_FAC = "fac";
-		static constexpr const char *IN_COLOR = "color";
+		static constexpr InputHandle<float> IN_FAC {"fac", 0};
+		static constexpr InputHandle<udm::Vector3> IN_COLOR {"color", 1};
 
-		static constexpr const char *OUT_COLOR = "color";
+		static constexpr OutputHandle<udm::Vector3> OUT_COLOR {"color", 0};
 
 		InvertNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -17,21 +17,27 @@ export namespace pragma::shadergraph {
 			Smootherstep,
 		};
 
-		static constexpr const char *CONST_TYPE = "type";
+		static constexpr InputHandle<Type> CONST_TYPE {"type", 0};
 
-		static constexpr const char *IN_VALUE = "value";
-		static constexpr const char *IN_FROM_MIN = "from_min";
-		static constexpr const char *IN_FROM_MAX = "from_max";
-		static constexpr const char *IN_TO_MIN = "to_min";
-		static constexpr const char *IN_TO_MAX = "to_max";
-		static constexpr const char *IN_STEPS = "steps";
-		static constexpr const char *IN_CLAMP = "clamp";
+		static constexpr InputHandle<float> IN_VALUE {"value", 1};
+		static constexpr InputHandle<float> IN_FROM_MIN {"from_min", 2};
+		static constexpr InputHandle<float> IN_FROM_MAX {"from_max", 3};
+		static constexpr InputHandle<float> IN_TO_MIN {"to_min", 4};
+		static constexpr InputHandle<float> IN_TO_MAX {"to_max", 5};
+		static constexpr InputHandle<float> IN_STEPS {"steps", 6};
+		static constexpr InputHandle<bool> IN_CLAMP {"clamp", 7};
 
-		static constexpr const char *OUT_RESULT = "result";
+		static constexpr OutputHandle<float> OUT_RESULT {"result", 0};
 
 		MapRangeNode(const std::string_view &type);
 
 		virtual void Expand(Graph &graph, GraphNode &gn) const override;
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual bool HasExpansion() const override { return true; }
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual uint32_t GetKernelVariant(const GraphNode &instance) const override;
+		virtual bool IsValidKernelVariant(uint32_t variant) const override { return IsEnumInputValue(CONST_TYPE.index, variant); }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -57,16 +57,22 @@ export namespace pragma::shadergraph {
 			FlooredModulo,
 		};
 
-		static constexpr const char *IN_OPERATION = "operation";
-		static constexpr const char *IN_CLAMP = "clamp";
-		static constexpr const char *IN_VALUE1 = "value1";
-		static constexpr const char *IN_VALUE2 = "value2";
-		static constexpr const char *IN_VALUE3 = "value3";
+		static constexpr InputHandle<Operation> IN_OPERATION {"operation", 0};
+		static constexpr InputHandle<bool> IN_CLAMP {"clamp", 1};
+		static constexpr InputHandle<float> IN_VALUE1 {"value1", 2};
+		static constexpr InputHandle<float> IN_VALUE2 {"value2", 3};
+		static constexpr InputHandle<float> IN_VALUE3 {"value3", 4};
 
-		static constexpr const char *OUT_VALUE = "value";
+		static constexpr OutputHandle<float> OUT_VALUE {"value", 0};
 
 		MathNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual uint32_t GetKernelVariant(const GraphNode &instance) const override;
+		virtual bool IsValidKernelVariant(uint32_t variant) const override { return IsEnumInputValue(IN_OPERATION.index, variant); }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
+		virtual void DoEvaluateKernelBatch(const BatchKernelArgs &args) const override;
 	};
 };
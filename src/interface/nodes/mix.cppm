@@ -32,16 +32,21 @@ export namespace pragma::shadergraph {
 			Exclusion,
 		};
 
-		static constexpr const char *IN_TYPE = "type";
-		static constexpr const char *IN_CLAMP = "clamp";
-		static constexpr const char *IN_FAC = "fac";
-		static constexpr const char *IN_COLOR1 = "color1";
-		static constexpr const char *IN_COLOR2 = "color2";
+		static constexpr InputHandle<Type> IN_TYPE {"type", 0};
+		static constexpr InputHandle<bool> IN_CLAMP {"clamp", 2};
+		static constexpr InputHandle<float> IN_FAC {"fac", 1};
+		static constexpr InputHandle<udm::Vector3> IN_COLOR1 {"color1", 3};
+		static constexpr InputHandle<udm::Vector3> IN_COLOR2 {"color2", 4};
 
-		static constexpr const char *OUT_COLOR = "color";
+		static constexpr OutputHandle<udm::Vector3> OUT_COLOR {"color", 0};
 
 		MixNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual uint32_t GetKernelVariant(const GraphNode &instance) const override;
+		virtual bool IsValidKernelVariant(uint32_t variant) const override { return IsEnumInputValue(IN_TYPE.index, variant); }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
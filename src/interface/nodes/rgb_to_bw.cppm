@@ -10,12 +10,15 @@ export namespace pragma::shadergraph {
 
 	class RgbToBwNode : public Node {
 	  public:
-		static constexpr const char *IN_COLOR = "color";
+		static constexpr InputHandle<udm::Vector3> IN_COLOR {"color", 0};
 
-		static constexpr const char *OUT_VAL = "val";
+		static constexpr OutputHandle<float> OUT_VAL {"val", 0};
 
 		RgbToBwNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
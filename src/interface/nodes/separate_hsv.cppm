@@ -10,14 +10,17 @@ export namespace pragma::shadergraph {
 
 	class SeparateHsv : public Node {
 	  public:
-		static constexpr const char *IN_COLOR = "color";
+		static constexpr InputHandle<udm::Vector3> IN_COLOR {"color", 0};
 
-		static constexpr const char *OUT_H = "h";
-		static constexpr const char *OUT_S = "s";
-		static constexpr const char *OUT_V = "v";
+		static constexpr OutputHandle<float> OUT_H {"h", 0};
+		static constexpr OutputHandle<float> OUT_S {"s", 1};
+		static constexpr OutputHandle<float> OUT_V {"v", 2};
 
 		SeparateHsv(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -11,14 +11,17 @@ export namespace pragma::shadergraph {
 
 	class SeparateXyzNode : public Node {
 	  public:
-		static constexpr const char *IN_VECTOR = "vector";
+		static constexpr InputHandle<udm::Vector3> IN_VECTOR {"vector", 0};
 
-		static constexpr const char *OUT_X = "x";
-		static constexpr const char *OUT_Y = "y";
-		static constexpr const char *OUT_Z = "z";
+		static constexpr OutputHandle<float> OUT_X {"x", 0};
+		static constexpr OutputHandle<float> OUT_Y {"y", 1};
+		static constexpr OutputHandle<float> OUT_Z {"z", 2};
 
 		SeparateXyzNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -10,12 +10,15 @@ export namespace pragma::shadergraph {
 
 	class ValueNode : public Node {
 	  public:
-		static constexpr const char *CONST_VALUE = "value";
+		static constexpr InputHandle<float> CONST_VALUE {"value", 0};
 
-		static constexpr const char *OUT_VALUE = "value";
+		static constexpr OutputHandle<float> OUT_VALUE {"value", 0};
 
 		ValueNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
 	};
 };
@@ -44,16 +44,22 @@ export namespace pragma::shadergraph {
 			MultiplyAdd,
 		};
 
-		static constexpr const char *IN_OPERATION = "operation";
-		static constexpr const char *IN_VECTOR1 = "vector1";
-		static constexpr const char *IN_VECTOR2 = "vector2";
-		static constexpr const char *IN_VECTOR3 = "vector3";
+		static constexpr InputHandle<Operation> IN_OPERATION {"operation", 0};
+		static constexpr InputHandle<udm::Vector3> IN_VECTOR1 {"vector1", 1};
+		static constexpr InputHandle<udm::Vector3> IN_VECTOR2 {"vector2", 2};
+		static constexpr InputHandle<udm::Vector3> IN_VECTOR3 {"vector3", 3};
 
-		static constexpr const char *OUT_VALUE = "value";
-		static constexpr const char *OUT_VECTOR = "vector";
+		static constexpr OutputHandle<float> OUT_VALUE {"value", 0};
+		static constexpr OutputHandle<udm::Vector3> OUT_VECTOR {"vector", 1};
 
 		VectorMathNode(const std::string_view &type);
 
-		virtual std::string DoEvaluate(const Graph &graph, const GraphNode &instance) const override;
+		virtual void DoEvaluate(const Graph &graph, const GraphNode &instance, CodeWriter &code) const override;
+
+		virtual bool HasKernel() const override { return true; }
+		virtual uint32_t GetKernelVariant(const GraphNode &instance) const override;
+		virtual bool IsValidKernelVariant(uint32_t variant) const override { return IsEnumInputValue(IN_OPERATION.index, variant); }
+		virtual void DoEvaluateKernel(const KernelArgs &args) const override;
+		virtual void DoEvaluateKernelBatch(const BatchKernelArgs &args) const override;
 	};
 };
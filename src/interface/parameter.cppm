@@ -8,6 +8,7 @@ module;
 export module pragma.shadergraph:parameter;
 
 import :enum_set;
+import :hash;
 export import pragma.udm;
 
 export namespace pragma::shadergraph {
@@ -279,9 +280,16 @@ export namespace pragma::shadergraph {
 				using TFrom = decltype(val);
 				using TTo = typename decltype(tag)::type;
 				if constexpr(udm::is_convertible<TFrom, TTo>()) {
-					if(!m_value)
-						m_value = new TTo {};
-					*static_cast<TTo *>(m_value) = udm::convert<TFrom, TTo>(val);
+					auto converted = udm::convert<TFrom, TTo>(val);
+					if constexpr(std::is_same_v<TTo, udm::String>) {
+						if(m_hasValue)
+							*m_string = std::move(converted);
+						else
+							m_string = new udm::String {std::move(converted)};
+					}
+					else
+						new(GetInlineValue<TTo>()) TTo {converted};
+					m_hasValue = true;
 					return true;
 				}
 				return false;
@@ -296,10 +304,13 @@ export namespace pragma::shadergraph {
 			return visit(m_type, [this, &outVal](auto tag) {
 				using TFrom = typename decltype(tag)::type;
 				using TTo = std::remove_cv_t<std::remove_reference_t<decltype(outVal)>>;
-				if(!m_value)
+				if(!m_hasValue)
 					return false;
 				if constexpr(udm::is_convertible<TFrom, TTo>()) {
-					outVal = udm::convert<TFrom, TTo>(*static_cast<TFrom *>(m_value));
+					if constexpr(std::is_same_v<TFrom, udm::String>)
+						outVal = udm::convert<TFrom, TTo>(*m_string);
+					else
+						outVal = udm::convert<TFrom, TTo>(*GetInlineValue<TFrom>());
 					return true;
 				}
 				return false;
@@ -307,12 +318,31 @@ export namespace pragma::shadergraph {
 		}
 
 		void Clear();
+		// Returns 0 if no value is set
+		hash::Hash GetHash() const;
 		DataType GetType() const { return m_type; }
-		const udm::DataValue GetData() const { return m_value; }
+		const udm::DataValue GetData() const;
 		operator bool() const;
 	  private:
+		// All types except for strings are trivially copyable and stored inline, so copying a value never allocates
+		// unless it is a string.
+		template<typename T>
+		T *GetInlineValue()
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(m_storage) && alignof(T) <= alignof(udm::Mat4), "Type cannot be stored inline!");
+			return std::launder(reinterpret_cast<T *>(m_storage.data()));
+		}
+		template<typename T>
+		const T *GetInlineValue() const
+		{
+			return const_cast<Value *>(this)->GetInlineValue<T>();
+		}
 		DataType m_type;
-		udm::DataValue m_value = nullptr;
+		bool m_hasValue = false;
+		union {
+			alignas(udm::Mat4) std::array<std::byte, sizeof(udm::Mat4)> m_storage;
+			udm::String *m_string;
+		};
 	};
 
 	struct Parameter {
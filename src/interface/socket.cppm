@@ -25,6 +25,26 @@ export namespace pragma::shadergraph {
 		~Socket();
 	};
 	using namespace pragma::math::scoped_enum::bitwise;
+
+	// Compile-time reference to a socket of a specific node type, consisting of the name and the position of the socket.
+	// The position is validated when the node type adds the socket (see Node::AddInput), so graph nodes can access the socket
+	// by index instead of looking it up by name. Handles convert to their name for the string-based API.
+	template<typename T>
+	struct InputHandle {
+		using ValueType = T;
+		constexpr InputHandle(const char *name, uint32_t index) : name {name}, index {index} {}
+		constexpr operator std::string_view() const { return name; }
+		const char *name;
+		uint32_t index;
+	};
+	template<typename T>
+	struct OutputHandle {
+		using ValueType = T;
+		constexpr OutputHandle(const char *name, uint32_t index) : name {name}, index {index} {}
+		constexpr operator std::string_view() const { return name; }
+		const char *name;
+		uint32_t index;
+	};
 };
 export {
 	REGISTER_ENUM_FLAGS(pragma::shadergraph::Socket::Flags)
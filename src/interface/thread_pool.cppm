@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+export module pragma.shadergraph:thread_pool;
+
+export namespace pragma::shadergraph {
+	// Work-stealing thread pool. Every worker has its own task queue, and submitted tasks are distributed round-robin over the queues.
+	// Workers take tasks from the back of their own queue, and once it is empty, steal tasks from the front of the other queues,
+	// so tasks of very different cost are still balanced over all workers.
+	class ThreadPool {
+	  public:
+		// The index of the worker that executes the task is passed as argument
+		using Task = std::function<void(uint32_t)>;
+
+		// If threadCount is 0, the number of hardware threads is used
+		ThreadPool(uint32_t threadCount = 0);
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+		// Finishes all remaining tasks
+		~ThreadPool();
+
+		uint32_t GetThreadCount() const { return m_threads.size(); }
+		// Tasks must not throw
+		void Submit(Task task);
+		// Blocks until all submitted tasks have been executed
+		void Wait();
+	  private:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+		bool TryPop(uint32_t threadIdx, Task &outTask);
+		void Run(uint32_t threadIdx);
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread> m_threads;
+		std::atomic<uint32_t> m_nextQueue = 0;
+
+		std::mutex m_mutex;
+		std::condition_variable m_taskAvailable;
+		std::condition_variable m_tasksDone;
+		// Number of tasks that are waiting in a queue, and number of tasks that haven't finished yet
+		size_t m_numQueued = 0;
+		size_t m_numPending = 0;
+		bool m_stop = false;
+	};
+};
@@ -6,6 +6,14 @@ export import :node;
 export import :graph;
 export import :graph_node;
 export import :node_registry;
+export import :kernel;
+export import :bytecode;
+export import :glsl_cache;
+export import :code_writer;
+export import :compiled_graph;
+export import :baked_graph;
+export import :thread_pool;
+export import :batch_compiler;
 export import :nodes.math;
 export import :nodes.vector_math;
 export import :nodes.bright_contrast;
@@ -26,3 +34,4 @@ export import :nodes.value;
 export import :parameter;
 export import :socket;
 export import :enum_set;
+export import :hash;